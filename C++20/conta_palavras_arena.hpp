@@ -0,0 +1,48 @@
+/*
+Arena de alocação sequencial ("bump allocator") para as chaves da contagem de
+palavras.
+
+Cada thread mantém a sua arena: as palavras distintas são copiadas para blocos
+grandes, um após o outro, e as tabelas de contagem guardam apenas
+`std::string_view`s que apontam para eles. Não há liberação individual; toda a
+memória é devolvida de uma vez quando a arena é destruída, depois que o
+resultado foi impresso. Assim, o número de alocações passa a ser proporcional
+ao tamanho do vocabulário dividido pelo tamanho do bloco, e não ao número de
+palavras do texto.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+class Arena {
+    static constexpr size_t TAMANHO_BLOCO = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocos;
+    char* livre = nullptr;
+    size_t restante = 0;
+
+public:
+    Arena() = default;
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+
+    // Copia `texto` para a arena e devolve a cópia, estável até a destruição da arena.
+    std::string_view guardar(std::string_view texto) {
+        if (texto.size() > restante) {
+            size_t tamanho = std::max(TAMANHO_BLOCO, texto.size());
+            blocos.push_back(std::make_unique_for_overwrite<char[]>(tamanho));
+            livre = blocos.back().get();
+            restante = tamanho;
+        }
+        std::memcpy(livre, texto.data(), texto.size());
+        std::string_view copia(livre, texto.size());
+        livre += texto.size();
+        restante -= texto.size();
+        return copia;
+    }
+};
@@ -0,0 +1,298 @@
+/*
+--------------------------------------
+Este programa faz parte do material que acompanha o curso "Programação Multithread: Modelos e Abstrações em Linguagens Contemporâneas", ministrado por "Gerson Geraldo H. Cavalheiro, Alexandro Baldassin, André Rauber Du Bois" nas Jornadas de Atualização de Informática (JAI 2024) e se encontra disponível em https://github.com/GersonCavalheiro/JAI2025. Ao utilizar, referenciar a fonte.
+--------------------------------------
+
+Descrição do Programa
+
+Este programa, escrito em C++20, mede a escalabilidade de cada fase da contagem de palavras de `conta_palavras_blocos`, usando os mesmos componentes (`conta_palavras_normalizar.hpp`, `conta_palavras_tabela.hpp` e `conta_palavras_arena.hpp`). Em `conta_palavras_blocos` as fases são fundidas em uma única passada; aqui elas são separadas por barreiras, para que o tempo de cada uma possa ser medido isoladamente:
+
+1. ler: leitura do arquivo (`pread`) para os buffers das threads;
+2. limpar: normalização do texto (separadores e minúsculas, ciente de UTF-8);
+3. separar: divisão do texto normalizado em palavras;
+4. contar: inserção das palavras nas tabelas de espalhamento de cada thread;
+5. agregar: combinação das tabelas parciais, fatia a fatia.
+
+O arquivo é dividido em uma faixa por thread, alinhada a fronteiras de palavras, e cada faixa é percorrida em pedaços de tamanho fixo, como no modo `--fluxo`; a memória usada é proporcional ao pedaço vezes o número de threads, mais o vocabulário. A medição é repetida para cada número de threads pedido, e a menor de várias repetições é a considerada.
+
+Para cada fase e número de threads, o programa emite o tempo, a vazão em MB/s, a aceleração em relação ao primeiro número de threads da lista e a eficiência (aceleração dividida pelo aumento do número de threads), em CSV ou JSON. A leitura normalmente vem da cache de páginas do sistema, que é aquecida antes da primeira medição.
+
+Parâmetros de Lançamento
+
+O programa exige um argumento na linha de comando:
+
+1. Caminho para o arquivo de texto (por exemplo, gerado por `conta_palavras_corpus`).
+
+E aceita, opcionalmente:
+
+- `--threads=1,2,4`: números de threads a medir (padrão: potências de 2 até o número de núcleos).
+- `--repeticoes=R`: repetições por número de threads (padrão 3).
+- `--tamanho_minimo=N`: tamanho mínimo das palavras contadas (padrão 1).
+- `--pedaco=MB`: tamanho do pedaço lido por thread em cada rodada (padrão 16).
+- `--formato=csv|json`: formato da saída (padrão csv).
+
+Exemplo de execução:
+
+./conta_palavras_corpus 256 corpus.txt
+./conta_palavras_bench corpus.txt --threads=1,2,4,8 --formato=json
+
+O alvo `make bench_conta` faz esses dois passos e grava `bench_conta.csv` e `bench_conta.json`.
+
+Recursos de Programação Concorrente Utilizados
+
+- `std::thread`: um grupo fixo de threads por medição, cada uma com a sua faixa do arquivo, a sua tabela e a sua arena.
+- `std::barrier` (C++20): separa as fases de cada rodada. A função de conclusão da barreira, executada por uma única thread quando todas chegam, registra o tempo da fase que terminou e decide se há outra rodada, sem travas adicionais.
+- Agregação por fatias, como em `conta_palavras_blocos`: a thread `t` combina as fatias t, t + P, t + 2P, ... de todas as tabelas parciais.
+*/
+
+#include <algorithm>
+#include <barrier>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "conta_palavras_arena.hpp"
+#include "conta_palavras_normalizar.hpp"
+#include "conta_palavras_tabela.hpp"
+
+using Relogio = std::chrono::steady_clock;
+
+enum Fase { Ler, Limpar, Separar, Contar, Agregar, FASES };
+const char* const nomes_fases[FASES] = {"ler", "limpar", "separar", "contar", "agregar"};
+
+struct Medicao {
+    double segundos[FASES] = {};
+    size_t palavras = 0;
+    size_t distintas = 0;
+};
+
+// Estado de uma thread: a sua faixa do arquivo e o pedaço da rodada corrente.
+struct Faixa {
+    size_t posicao = 0, fim = 0;
+    std::vector<char> bruto, normal;
+    size_t tamanho = 0;     // bytes válidos em `bruto`
+    size_t transporte = 0;  // palavra incompleta no início de `bruto`
+    size_t corte = 0;       // bytes de `normal` separados nesta rodada
+    std::vector<std::string_view> palavras;
+};
+
+size_t ler_em(int fd, char* destino, size_t n, size_t posicao) {
+    size_t lidos = 0;
+    while (lidos < n) {
+        ssize_t r = ::pread(fd, destino + lidos, n - lidos, posicao + lidos);
+        if (r == 0) break;
+        if (r < 0) throw std::runtime_error("Erro ao ler o arquivo.");
+        lidos += r;
+    }
+    return lidos;
+}
+
+// Divide [0, tamanho) em `partes` faixas, avançando cada limite até logo após
+// um separador, como `dividir_em_faixas` de conta_palavras_blocos.
+std::vector<size_t> limites_das_faixas(int fd, size_t tamanho, size_t partes) {
+    std::vector<size_t> limites{0};
+    char c;
+    for (size_t i = 1; i < partes; ++i) {
+        size_t fim = std::max(limites.back(), tamanho * i / partes);
+        while (fim > 0 && fim < tamanho && ler_em(fd, &c, 1, fim - 1) == 1 && !normalizacao::separador_ascii(c))
+            ++fim;
+        limites.push_back(fim);
+    }
+    limites.push_back(tamanho);
+    return limites;
+}
+
+Medicao medir(int fd, size_t tamanho, size_t num_threads, size_t tamanho_minimo, size_t pedaco) {
+    std::vector<size_t> limites = limites_das_faixas(fd, tamanho, num_threads);
+    std::vector<Faixa> faixas(num_threads);
+    for (size_t t = 0; t < num_threads; ++t) {
+        faixas[t].posicao = limites[t];
+        faixas[t].fim = limites[t + 1];
+    }
+    const int bits_fatia = std::bit_width(4 * num_threads - 1);
+    std::vector<TabelaFatiada> mapas(num_threads, TabelaFatiada(bits_fatia));
+    std::vector<Arena> arenas(num_threads);
+
+    Medicao m;
+    int fase = Ler;
+    bool terminou = false;
+    Relogio::time_point marca = Relogio::now();
+    std::barrier sincronizar(num_threads, [&]() noexcept {
+        Relogio::time_point agora = Relogio::now();
+        m.segundos[fase] += std::chrono::duration<double>(agora - marca).count();
+        marca = agora;
+        fase = (fase + 1) % Agregar;
+        if (fase == Ler)
+            terminou = std::all_of(faixas.begin(), faixas.end(), [](const Faixa& f) {
+                return f.posicao == f.fim && f.transporte == 0;
+            });
+    });
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            Faixa& f = faixas[t];
+            auto guardar = [&](std::string_view p) { return arenas[t].guardar(p); };
+            while (!terminou) {
+                size_t n = std::min(pedaco, f.fim - f.posicao);
+                if (f.bruto.size() < f.transporte + n) f.bruto.resize(f.transporte + n);
+                f.tamanho = f.transporte + ler_em(fd, f.bruto.data() + f.transporte, n, f.posicao);
+                f.posicao += n;
+                sincronizar.arrive_and_wait();
+
+                if (f.normal.size() < f.tamanho) f.normal.resize(f.tamanho);
+                normalizar(f.bruto.data(), f.normal.data(), f.tamanho);
+                sincronizar.arrive_and_wait();
+
+                // A palavra cortada no fim do pedaço fica para a próxima rodada.
+                const char* p = f.normal.data();
+                f.corte = f.tamanho;
+                if (f.posicao < f.fim)
+                    while (f.corte > 0 && p[f.corte - 1] != ' ') --f.corte;
+                f.palavras.clear();
+                for (size_t j = 0; j < f.corte; ) {
+                    while (j < f.corte && p[j] == ' ') ++j;
+                    size_t comeco = j;
+                    while (j < f.corte && p[j] != ' ') ++j;
+                    if (j > comeco && j - comeco >= tamanho_minimo) f.palavras.emplace_back(p + comeco, j - comeco);
+                }
+                sincronizar.arrive_and_wait();
+
+                for (std::string_view palavra : f.palavras) mapas[t].somar(palavra, 1, guardar);
+                f.transporte = f.tamanho - f.corte;
+                std::copy(f.bruto.begin() + f.corte, f.bruto.begin() + f.tamanho, f.bruto.begin());
+                sincronizar.arrive_and_wait();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::vector<TabelaPalavras> resultado(size_t{1} << bits_fatia);
+    Relogio::time_point inicio = Relogio::now();
+    threads.clear();
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t f = t; f < resultado.size(); f += num_threads)
+                for (const auto& parcial : mapas)
+                    parcial[f].para_cada([&](const TabelaPalavras::Entrada& e) {
+                        resultado[f].somar(e.chave, e.hash, e.contagem, [](std::string_view p) { return p; });
+                    });
+        });
+    }
+    for (auto& t : threads) t.join();
+    m.segundos[Agregar] = std::chrono::duration<double>(Relogio::now() - inicio).count();
+
+    for (const auto& fatia : resultado) {
+        m.distintas += fatia.tamanho();
+        fatia.para_cada([&](const TabelaPalavras::Entrada& e) { m.palavras += e.contagem; });
+    }
+    return m;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " <arquivo.txt> [--threads=1,2,4] [--repeticoes=R]"
+                  << " [--tamanho_minimo=N] [--pedaco=MB] [--formato=csv|json]\n";
+        return 1;
+    }
+
+    std::string caminho = argv[1];
+    std::vector<size_t> contagens_threads;
+    size_t repeticoes = 3, tamanho_minimo = 1, pedaco = size_t{16} << 20;
+    bool json = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string opcao = argv[i];
+        if (opcao.starts_with("--threads=")) {
+            std::stringstream lista(opcao.substr(10));
+            for (std::string item; std::getline(lista, item, ','); )
+                contagens_threads.push_back(std::max<size_t>(1, std::stoul(item)));
+        } else if (opcao.starts_with("--repeticoes=")) repeticoes = std::max<size_t>(1, std::stoul(opcao.substr(13)));
+        else if (opcao.starts_with("--tamanho_minimo=")) tamanho_minimo = std::stoul(opcao.substr(17));
+        else if (opcao.starts_with("--pedaco=")) pedaco = std::max<size_t>(1, std::stoul(opcao.substr(9))) << 20;
+        else if (opcao == "--formato=json") json = true;
+        else if (opcao == "--formato=csv") json = false;
+        else {
+            std::cerr << "Opcao desconhecida: " << opcao << '\n';
+            return 1;
+        }
+    }
+    if (contagens_threads.empty()) {
+        const size_t nucleos = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t p = 1; p < nucleos; p *= 2) contagens_threads.push_back(p);
+        contagens_threads.push_back(nucleos);
+    }
+
+    try {
+        int fd = ::open(caminho.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) throw std::runtime_error("Erro ao abrir o arquivo.");
+        const size_t tamanho = st.st_size;
+        const double megabytes = tamanho / double(1 << 20);
+
+        // Aquece a cache de páginas, para que todas as medições partam do mesmo estado.
+        medir(fd, tamanho, 1, tamanho_minimo, pedaco);
+
+        std::vector<Medicao> melhores;
+        for (size_t p : contagens_threads) {
+            Medicao melhor;
+            for (size_t r = 0; r < repeticoes; ++r) {
+                Medicao m = medir(fd, tamanho, p, tamanho_minimo, pedaco);
+                for (int f = 0; f < FASES; ++f)
+                    melhor.segundos[f] = r == 0 ? m.segundos[f] : std::min(melhor.segundos[f], m.segundos[f]);
+                melhor.palavras = m.palavras;
+                melhor.distintas = m.distintas;
+            }
+            melhores.push_back(melhor);
+            std::cerr << p << " threads: " << melhor.palavras << " palavras, " << melhor.distintas << " distintas\n";
+        }
+        ::close(fd);
+
+        std::cout << std::fixed << std::setprecision(6);
+        if (json) std::cout << "[\n";
+        else std::cout << "fase,threads,segundos,mb_s,aceleracao,eficiencia\n";
+        const size_t base = contagens_threads.front();
+        for (int f = 0; f <= FASES; ++f) {  // f == FASES: total das fases
+            auto tempo = [&](const Medicao& m) {
+                if (f < FASES) return m.segundos[f];
+                double total = 0;
+                for (double s : m.segundos) total += s;
+                return total;
+            };
+            const char* nome = f < FASES ? nomes_fases[f] : "total";
+            for (size_t i = 0; i < melhores.size(); ++i) {
+                size_t p = contagens_threads[i];
+                double s = tempo(melhores[i]);
+                double aceleracao = s > 0 ? tempo(melhores[0]) / s : 0;
+                double eficiencia = aceleracao * base / p;
+                if (json) {
+                    bool ultimo = f == FASES && i + 1 == melhores.size();
+                    std::cout << "  {\"fase\": \"" << nome << "\", \"threads\": " << p << ", \"segundos\": " << s
+                              << ", \"mb_s\": " << megabytes / s << ", \"aceleracao\": " << aceleracao
+                              << ", \"eficiencia\": " << eficiencia << "}" << (ultimo ? "\n" : ",\n");
+                } else {
+                    std::cout << nome << ',' << p << ',' << s << ',' << megabytes / s << ','
+                              << aceleracao << ',' << eficiencia << '\n';
+                }
+            }
+        }
+        if (json) std::cout << "]\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
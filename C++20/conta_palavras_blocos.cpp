@@ -5,126 +5,672 @@ Este programa faz parte do material que acompanha o curso "Programação Multith
 
 Descrição do Programa
 
-Este programa, escrito em C++20, realiza a contagem de palavras em um arquivo de texto utilizando paralelismo baseado em blocos. Ele divide o conjunto de palavras extraídas em partes proporcionais ao número de núcleos disponíveis na máquina, processando essas partes em paralelo para acelerar a contagem. Ao final, os resultados parciais são agregados em um único mapa contendo as palavras e suas respectivas frequências.
+Este programa, escrito em C++20, realiza a contagem de palavras em um arquivo de texto utilizando paralelismo baseado em blocos. O arquivo é mapeado em memória (`mmap`) e dividido em faixas de bytes, uma por núcleo disponível, com os limites deslocados até o fim da palavra corrente, de modo que nenhuma palavra fique dividida entre duas faixas. Cada faixa é limpa (pontuação vira separador e letras são convertidas para minúsculas, inclusive as acentuadas do Latin-1 codificadas em UTF-8), separada em palavras e contada em uma única passada paralela. Ao final, os resultados parciais são agregados em um único mapa contendo as palavras e suas respectivas frequências.
 
 Parâmetros de Lançamento
 
 O programa exige dois argumentos na linha de comando:
 
-1. Caminho para um arquivo de texto.
+1. Caminho para um arquivo de texto, um diretório (todos os arquivos dele e dos subdiretórios), `@lista` (um arquivo com um caminho por linha) ou `-` para ler da entrada padrão.
 2. Tamanho mínimo das palavras a serem consideradas.
 
+E aceita, opcionalmente, as opções:
+
+- `--fluxo[=MB]`: em vez de mapear o arquivo inteiro, lê a entrada em trechos de MB megabytes (padrão 1), de modo que a memória usada seja proporcional ao tamanho do trecho vezes o número de threads, mais o vocabulário. É o modo usado com a entrada padrão, o que permite, por exemplo, `zcat corpus.gz | ./conta_palavras_blocos - 4`.
+- `--topo=K`: imprime apenas as K palavras mais frequentes, da mais para a menos frequente (empates em ordem alfabética), em vez do vocabulário inteiro sem ordem.
+- `--aproximado[=contadores]`: junto com `--topo=K`, troca as tabelas exatas por um resumo Space-Saving de tamanho fixo por thread (padrão 10K contadores). Cada palavra impressa vem com o erro máximo da sua contagem (a contagem real está entre `contagem - erro` e `contagem`), e a saída de erro informa o limite de erro geral e quantas das K posições são garantidas. A memória independe do tamanho do vocabulário.
+- `--indice=arquivo`: em vez de imprimir as contagens, grava-as em um índice persistente (`conta_palavras_indice.hpp`) com o vocabulário ordenado, a contagem de cada palavra em cada arquivo e uma impressão digital (tamanho, data e hash do conteúdo) de cada arquivo. Se o índice já existe, apenas os arquivos novos ou alterados são recontados e intercalados com as contagens anteriores; os removidos saem do índice. O próprio índice e o seu arquivo temporário (`arquivo.tmp`) nunca são contados, mesmo dentro do diretório de entrada.
+
+O índice pode então ser consultado sem recontagem nem carga completa, com
+
+./conta_palavras_blocos --consultar=arquivo palavra...
+
+que imprime o total de cada palavra e a sua contagem em cada arquivo.
+
 Exemplo de execução:
 
 ./conta_palavras_bloco ../files/anahy.txt 4
 
-Esse comando contará todas as palavras com pelo menos 4 caracteres no arquivo `arquivo.txt`.
+Esse comando contará todas as palavras com pelo menos 4 caracteres no arquivo `arquivo.txt`. Já
+
+./conta_palavras_blocos ../files/anahy.txt 4 --topo=1000 --aproximado
+
+imprime uma estimativa das 1000 palavras mais frequentes.
 
 Recursos de Programação Concorrente Utilizados
 
 O programa faz uso do paralelismo de dados via algoritmo `std::for_each` com a política de execução `std::execution::par`, introduzida no C++17 e padronizada no C++20 para ambientes com suporte a execução paralela. Outros recursos relevantes:
 
 - `std::thread::hardware_concurrency()`: determina o número de *cores* disponíveis, utilizado para definir o número de blocos.
-- Divisão manual dos dados: o vetor de palavras é segmentado em intervalos para processamento independente.
-- `std::unordered_map`: cada bloco utiliza um mapa separado para registrar suas contagens, evitando a necessidade de sincronização.
-- Agregação sequencial: os mapas parciais são combinados em um único resultado final após o processamento paralelo.
+- Normalização vetorizada (`conta_palavras_normalizar.hpp`): separadores e maiúsculas ASCII são tratados 32 ou 16 bytes por instrução (AVX2 ou SSE2, com caminho escalar para outras arquiteturas), e os trechos com bytes não ASCII são decodificados como UTF-8, de modo que palavras acentuadas (por exemplo, "Época" e "época") são reconhecidas e contadas juntas.
+- Mapeamento do arquivo em memória (`mmap`): as threads leem o texto diretamente das páginas do arquivo, sem a cópia para um `std::string`.
+- Divisão manual dos dados: o texto é segmentado em faixas de bytes alinhadas a fronteiras de palavras, processadas de forma independente.
+- Tabelas de espalhamento planas (`conta_palavras_tabela.hpp`): cada bloco utiliza uma tabela separada para registrar suas contagens, evitando a necessidade de sincronização. As tabelas usam endereçamento aberto com bytes de controle comparados 16 a 16 (SSE2) e são divididas em fatias pelos bits altos do hash. As chaves são `std::string_view`: a busca usa a própria fatia do texto normalizado, em um buffer reaproveitado pela thread, e só na primeira ocorrência de cada palavra a chave é copiada para a arena da thread (`conta_palavras_arena.hpp`). Ao final, o programa relata na saída de erro o número de alocações e o pico de memória residente.
+- Modo em fluxo: uma thread leitora preenche trechos de tamanho fixo, transportando a palavra incompleta do fim de um trecho para o início do seguinte, e os entrega às threads contadoras por filas limitadas (`conta_palavras_fila.hpp`, com `std::mutex` e `std::condition_variable`); os trechos contados voltam à leitora por uma segunda fila e são reaproveitados.
+- Agregação paralela por fatias: cada tarefa de um segundo `std::for_each` com `std::execution::par` combina a mesma fatia de todas as tabelas parciais; como as fatias são disjuntas, a agregação dispensa travas e escala com o número de núcleos.
+- Vários arquivos: as threads retiram arquivos inteiros de um cursor atômico, do maior para o menor, para equilibrar a carga. No modo `--indice`, cada arquivo tem a sua própria tabela; as ocorrências novas são ordenadas com `std::sort` e `std::execution::par` e intercaladas com o vocabulário do índice anterior, lido diretamente do arquivo mapeado. O índice novo é gravado em um arquivo temporário e renomeado sobre o antigo, e as consultas fazem busca binária no vocabulário mapeado em memória.
+- Seleção das mais frequentes (`conta_palavras_topo.hpp`): no modo exato, cada fatia do resultado escolhe as suas K maiores entradas com `std::partial_sort`, em paralelo, antes de uma seleção final entre os candidatos; no modo aproximado, cada thread alimenta o seu próprio resumo Space-Saving, sem sincronização, e os resumos são mesclados ao final preservando os limites de erro.
 
 Esse modelo de paralelismo é ideal para tarefas que envolvem grande volume de dados e podem ser divididas em partes independentes, com custo reduzido de sincronização entre threads. Ele demonstra como combinar programação funcional e concorrente com as ferramentas da biblioteca padrão do C++.
 */ 
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <unordered_map>
+#include <exception>
+#include <memory>
 #include <vector>
 #include <string>
-#include <cctype>
+#include <string_view>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include <algorithm>
+#include <bit>
 #include <execution>
 #include <iterator>
+#include <stdexcept>
+#include <mutex>
 #include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
-std::string limpar_pontuacao(std::string&& texto) {
-    for (char& c : texto) {
-        if (std::ispunct(static_cast<unsigned char>(c)) || c == '"' || c == '\'')
-            c = ' ';
-        else
-            c = std::tolower(static_cast<unsigned char>(c));
+#include "conta_palavras_arena.hpp"
+#include "conta_palavras_fila.hpp"
+#include "conta_palavras_indice.hpp"
+#include "conta_palavras_normalizar.hpp"
+#include "conta_palavras_tabela.hpp"
+#include "conta_palavras_topo.hpp"
+
+// Contadores de alocação: os operadores globais de alocação são substituídos
+// por versões que contam as chamadas e os bytes pedidos.
+std::atomic<size_t> total_alocacoes{0}, bytes_alocados{0};
+
+void* operator new(size_t tamanho) {
+    total_alocacoes.fetch_add(1, std::memory_order_relaxed);
+    bytes_alocados.fetch_add(tamanho, std::memory_order_relaxed);
+    if (void* p = std::malloc(tamanho ? tamanho : 1)) return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Arquivo mapeado somente para leitura; desfaz o mapeamento ao sair de escopo.
+class ArquivoMapeado {
+    const char* dados_ = nullptr;
+    size_t tamanho_ = 0;
+
+public:
+    explicit ArquivoMapeado(const char* caminho) {
+        int fd = ::open(caminho, O_RDONLY);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            if (fd >= 0) ::close(fd);
+            throw std::runtime_error("Erro ao abrir o arquivo.");
+        }
+        tamanho_ = st.st_size;
+        if (tamanho_ > 0) {
+            void* mapa = ::mmap(nullptr, tamanho_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapa == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Erro ao mapear o arquivo.");
+            }
+            ::madvise(mapa, tamanho_, MADV_SEQUENTIAL);
+            dados_ = static_cast<const char*>(mapa);
+        }
+        ::close(fd);
+    }
+    ~ArquivoMapeado() {
+        if (dados_) ::munmap(const_cast<char*>(dados_), tamanho_);
     }
-    return std::move(texto);
+    ArquivoMapeado(const ArquivoMapeado&) = delete;
+    ArquivoMapeado& operator=(const ArquivoMapeado&) = delete;
+
+    const char* dados() const { return dados_; }
+    size_t tamanho() const { return tamanho_; }
+};
+
+// Pontuação (incluindo aspas) e espaços ASCII separam palavras. Basta para
+// escolher onde cortar o texto; a classificação completa, que reconhece também
+// os separadores do Latin-1 em UTF-8, é feita por `normalizar`.
+inline bool eh_separador(char c) {
+    return normalizacao::separador_ascii(static_cast<unsigned char>(c));
 }
 
-std::vector<std::string> separar_palavras(const std::string& texto, size_t tamanho_minimo) {
-    std::istringstream iss(texto);
-    std::vector<std::string> palavras;
-    std::string palavra;
-    while (iss >> palavra) {
-        if (palavra.size() >= tamanho_minimo)
-            palavras.push_back(palavra);
+// Divide [0, tamanho) em até `partes` faixas. Cada limite avança até logo após
+// um separador, para que nenhuma palavra seja cortada entre duas faixas.
+std::vector<std::pair<size_t, size_t>> dividir_em_faixas(const char* texto, size_t tamanho, size_t partes) {
+    std::vector<std::pair<size_t, size_t>> faixas;
+    size_t inicio = 0;
+    for (size_t i = 1; i <= partes && inicio < tamanho; ++i) {
+        size_t fim = i == partes ? tamanho : std::max(inicio, tamanho * i / partes);
+        while (fim < tamanho && fim > 0 && !eh_separador(texto[fim - 1]))
+            ++fim;
+        if (fim > inicio) faixas.emplace_back(inicio, fim);
+        inicio = fim;
     }
-    return palavras;
+    return faixas;
 }
 
-void agregar_mapas(std::unordered_map<std::string, size_t>& destino,
-                   const std::unordered_map<std::string, size_t>& origem) {
-    for (const auto& [palavra, contagem] : origem) {
-        destino[palavra] += contagem;
+// Limpa, separa e conta as palavras de uma faixa em uma única passada. O texto
+// é normalizado em pedaços para um buffer da thread, e as palavras são fatias
+// desse buffer; a palavra cortada no fim de um pedaço é normalizada de novo no
+// início do seguinte. Cada palavra aceita é entregue a `contar`, válida apenas
+// durante a chamada.
+template <typename Contar>
+void contar_faixa(const char* texto, size_t inicio, size_t fim, size_t tamanho_minimo, Contar&& contar) {
+    constexpr size_t PEDACO = 64 * 1024;
+    std::vector<char> normal;
+    for (size_t i = inicio; i < fim; ) {
+        size_t n = std::min(PEDACO, fim - i), corte;
+        while (true) {
+            if (normal.size() < n) normal.resize(n);
+            normalizar(texto + i, normal.data(), n);
+            corte = n;
+            if (i + n == fim) break;
+            while (corte > 0 && normal[corte - 1] != ' ') --corte;
+            if (corte > 0) break;
+            n = std::min(2 * n, fim - i);  // palavra maior que o pedaço
+        }
+        const char* p = normal.data();
+        for (size_t j = 0; j < corte; ) {
+            while (j < corte && p[j] == ' ') ++j;
+            size_t comeco = j;
+            while (j < corte && p[j] != ' ') ++j;
+            size_t tamanho = j - comeco;
+            if (tamanho > 0 && tamanho >= tamanho_minimo)
+                contar(std::string_view(p + comeco, tamanho));
+        }
+        i += corte;
     }
 }
 
-int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Uso: " << argv[0] << " <arquivo.txt> <tamanho_minimo_palavra>\n";
-        return 1;
+// Agrega a fatia `f` de todas as tabelas parciais. As chaves já estão nas
+// arenas, que vivem até o fim, e são reaproveitadas sem cópia.
+void agregar_fatia(TabelaPalavras& destino, const std::vector<TabelaFatiada>& parciais, size_t f) {
+    for (const auto& parcial : parciais) {
+        parcial[f].para_cada([&](const TabelaPalavras::Entrada& e) {
+            destino.somar(e.chave, e.hash, e.contagem, [](std::string_view p) { return p; });
+        });
     }
+}
 
-    std::ifstream arquivo(argv[1]);
-    if (!arquivo) {
-        std::cerr << "Erro ao abrir o arquivo.\n";
-        return 1;
+// Trecho da entrada no modo em fluxo.
+struct Trecho {
+    std::vector<char> dados;
+    size_t tamanho = 0;
+};
+
+// Lê até `n` bytes, repetindo a leitura se ela vier parcial (como em pipes).
+size_t ler_completo(int fd, char* destino, size_t n) {
+    size_t lidos = 0;
+    while (lidos < n) {
+        ssize_t r = ::read(fd, destino + lidos, n - lidos);
+        if (r == 0) break;
+        if (r < 0) throw std::runtime_error("Erro ao ler a entrada.");
+        lidos += r;
     }
+    return lidos;
+}
 
-    size_t tamanho_minimo = std::stoul(argv[2]);
+// Modo em fluxo: esta thread lê a entrada em trechos de `tamanho_trecho` bytes e
+// os entrega, por uma fila limitada, a `num_threads` threads contadoras, que
+// devolvem os trechos já contados por uma segunda fila. A palavra incompleta ao
+// fim de um trecho é transportada para o início do seguinte. Circulam apenas
+// num_threads + 2 trechos, o que limita a memória independentemente do tamanho
+// da entrada. A thread contadora `t` chama `processar(t, dados, tamanho)`.
+template <typename Processar>
+void contar_fluxo(int fd, size_t tamanho_trecho, size_t num_threads, Processar&& processar) {
+    const size_t total = num_threads + 2;
+    FilaLimitada<std::unique_ptr<Trecho>> livres(total), cheios(total);
+    for (size_t i = 0; i < total; ++i) livres.push(std::make_unique<Trecho>());
 
-    std::ostringstream oss;
-    char c;
-    while (arquivo.get(c)) {
-        oss << c;
+    std::vector<std::thread> contadores;
+    for (size_t t = 0; t < num_threads; ++t) {
+        contadores.emplace_back([&, t] {
+            while (auto trecho = cheios.pop()) {
+                processar(t, (*trecho)->dados.data(), (*trecho)->tamanho);
+                livres.push(std::move(*trecho));
+            }
+        });
     }
 
-    std::string texto = limpar_pontuacao(std::move(oss.str()));
-    std::vector<std::string> palavras = separar_palavras(texto, tamanho_minimo);
+    std::exception_ptr erro;
+    try {
+        std::unique_ptr<Trecho> atual = *livres.pop();
+        size_t transporte = 0;
+        while (true) {
+            if (atual->dados.size() < transporte + tamanho_trecho)
+                atual->dados.resize(transporte + tamanho_trecho);
+            size_t lidos = ler_completo(fd, atual->dados.data() + transporte, tamanho_trecho);
+            size_t tamanho = transporte + lidos;
+            if (lidos < tamanho_trecho) {  // fim da entrada
+                atual->tamanho = tamanho;
+                cheios.push(std::move(atual));
+                break;
+            }
+            size_t corte = tamanho;
+            while (corte > 0 && !eh_separador(atual->dados[corte - 1])) --corte;
+            if (corte == 0) {
+                // Palavra maior que um trecho: continua lendo no mesmo trecho.
+                transporte = tamanho;
+                continue;
+            }
+            std::unique_ptr<Trecho> proximo = *livres.pop();
+            transporte = tamanho - corte;
+            if (proximo->dados.size() < transporte + tamanho_trecho)
+                proximo->dados.resize(transporte + tamanho_trecho);
+            std::copy_n(atual->dados.data() + corte, transporte, proximo->dados.data());
+            atual->tamanho = corte;
+            cheios.push(std::move(atual));
+            atual = std::move(proximo);
+        }
+    } catch (...) {
+        erro = std::current_exception();
+    }
+    cheios.fechar();
+    for (auto& t : contadores) t.join();
+    if (erro) std::rethrow_exception(erro);
+}
 
-    const size_t num_threads = std::thread::hardware_concurrency();
-    const size_t bloco = palavras.size() / num_threads;
+// Arquivo de entrada, com os metadados usados para detectar alterações.
+struct Entrada {
+    std::string caminho;
+    std::uint64_t tamanho = 0;
+    std::int64_t modificacao = 0;  // nanossegundos
+};
 
-    std::vector<std::pair<size_t, size_t>> blocos;
-    for (size_t i = 0; i < num_threads; ++i) {
-        size_t inicio = i * bloco;
-        size_t fim = (i == num_threads - 1) ? palavras.size() : inicio + bloco;
-        blocos.emplace_back(inicio, fim);
+// Lista os arquivos a contar, em ordem de caminho. `caminho` pode ser um
+// arquivo, um diretório (percorrido recursivamente) ou `@lista`, um arquivo com
+// um caminho por linha. Os caminhos em `excluir` (o próprio índice e o seu
+// temporário, que podem estar dentro do diretório contado) são ignorados.
+std::vector<Entrada> listar_entradas(const std::string& caminho, const std::vector<std::string>& excluir = {}) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> caminhos;
+    if (caminho.starts_with("@")) {
+        std::ifstream lista(caminho.substr(1));
+        if (!lista) throw std::runtime_error("Erro ao abrir a lista " + caminho.substr(1) + ".");
+        for (std::string linha; std::getline(lista, linha); )
+            if (!linha.empty()) caminhos.push_back(linha);
+    } else if (fs::is_directory(caminho)) {
+        for (const auto& item : fs::recursive_directory_iterator(caminho))
+            if (item.is_regular_file()) caminhos.push_back(item.path().string());
+    } else {
+        caminhos.push_back(caminho);
     }
+    std::sort(caminhos.begin(), caminhos.end());
+    caminhos.erase(std::unique(caminhos.begin(), caminhos.end()), caminhos.end());
+    std::vector<fs::path> ignorados;
+    for (const auto& e : excluir) ignorados.push_back(fs::weakly_canonical(e));
+    std::erase_if(caminhos, [&](const std::string& c) {
+        return std::find(ignorados.begin(), ignorados.end(), fs::weakly_canonical(c)) != ignorados.end();
+    });
 
-    std::vector<std::unordered_map<std::string, size_t>> mapas_parciais(blocos.size());
+    std::vector<Entrada> entradas;
+    for (auto& c : caminhos) {
+        struct stat st;
+        if (::stat(c.c_str(), &st) != 0) throw std::runtime_error("Erro ao abrir o arquivo " + c + ".");
+        std::int64_t modificacao = std::int64_t{st.st_mtim.tv_sec} * 1'000'000'000 + st.st_mtim.tv_nsec;
+        entradas.push_back(Entrada{std::move(c), static_cast<std::uint64_t>(st.st_size), modificacao});
+    }
+    return entradas;
+}
 
-    std::for_each(std::execution::par, blocos.begin(), blocos.end(),
-        [&](const std::pair<size_t, size_t>& intervalo) {
-            size_t idx = &intervalo - &blocos[0]; // índice do bloco
-            auto& mapa = mapas_parciais[idx];
-            for (size_t i = intervalo.first; i < intervalo.second; ++i) {
-                ++mapa[palavras[i]];
+// Distribui os arquivos `selecionados` entre `num_threads` threads, do maior
+// para o menor, o que equilibra a carga quando os tamanhos variam muito. Cada
+// thread retira o próximo arquivo de um cursor atômico e chama `f(t, i)`.
+template <typename F>
+void distribuir_arquivos(const std::vector<Entrada>& entradas, std::vector<size_t> selecionados,
+                         size_t num_threads, F&& f) {
+    std::sort(selecionados.begin(), selecionados.end(), [&](size_t a, size_t b) {
+        return entradas[a].tamanho > entradas[b].tamanho;
+    });
+    std::atomic<size_t> proximo{0};
+    std::exception_ptr erro;
+    std::mutex mtx_erro;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::min(num_threads, selecionados.size()); ++t) {
+        threads.emplace_back([&, t] {
+            try {
+                for (size_t k; (k = proximo.fetch_add(1)) < selecionados.size(); )
+                    f(t, selecionados[k]);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mtx_erro);
+                if (!erro) erro = std::current_exception();
             }
         });
+    }
+    for (auto& t : threads) t.join();
+    if (erro) std::rethrow_exception(erro);
+}
 
-    std::unordered_map<std::string, size_t> resultado_final;
-    for (const auto& mapa : mapas_parciais) {
-        agregar_mapas(resultado_final, mapa);
+// Cria ou atualiza o índice em `caminho_indice` com as contagens de cada
+// entrada. Um arquivo cujo tamanho e data coincidem com os do índice anterior
+// não é lido; se só a data mudou, o hash do conteúdo decide. Apenas os
+// arquivos alterados ou novos são recontados, em paralelo, e as suas
+// ocorrências são intercaladas com as do vocabulário anterior, já ordenado.
+void atualizar_indice(const std::string& caminho_indice, const std::vector<Entrada>& entradas,
+                      size_t tamanho_minimo, size_t num_threads) {
+    std::unique_ptr<indice::IndiceMapeado> antigo;
+    if (::access(caminho_indice.c_str(), F_OK) == 0) {
+        antigo = std::make_unique<indice::IndiceMapeado>(caminho_indice);
+        // Contado com outro tamanho mínimo: nada pode ser reaproveitado.
+        if (antigo->tamanho_minimo() != tamanho_minimo) antigo.reset();
     }
+    std::unordered_map<std::string_view, size_t> anteriores;
+    for (size_t a = 0; antigo && a < antigo->num_arquivos(); ++a)
+        anteriores.emplace(antigo->caminho(antigo->arquivo(a)), a);
 
-    for (const auto& [palavra, contagem] : resultado_final) {
-        std::cout << palavra << ": " << contagem << '\n';
+    const size_t n = entradas.size();
+    constexpr size_t NENHUM = SIZE_MAX;
+    std::vector<size_t> origem(n, NENHUM);  // arquivo antigo cujas contagens continuam valendo
+    std::vector<indice::RegistroArquivo> registros(n);
+    std::vector<size_t> pendentes;
+    size_t mantidos = 0;
+    for (size_t i = 0; i < n; ++i) {
+        registros[i].tamanho = entradas[i].tamanho;
+        registros[i].modificacao = entradas[i].modificacao;
+        auto it = anteriores.find(entradas[i].caminho);
+        if (it != anteriores.end()) {
+            ++mantidos;
+            const auto& a = antigo->arquivo(it->second);
+            if (a.tamanho == entradas[i].tamanho && a.modificacao == entradas[i].modificacao) {
+                origem[i] = it->second;
+                registros[i].hash = a.hash;
+                registros[i].palavras = a.palavras;
+                continue;
+            }
+        }
+        pendentes.push_back(i);
     }
 
-    return 0;
+    std::vector<TabelaPalavras> tabelas(n);
+    std::vector<Arena> arenas(num_threads);
+    distribuir_arquivos(entradas, pendentes, num_threads, [&](size_t t, size_t i) {
+        ArquivoMapeado arquivo(entradas[i].caminho.c_str());
+        registros[i].tamanho = arquivo.tamanho();
+        registros[i].hash = hash_palavra(std::string_view(arquivo.dados(), arquivo.tamanho()));
+        if (auto it = anteriores.find(entradas[i].caminho); it != anteriores.end()) {
+            const auto& a = antigo->arquivo(it->second);
+            if (a.tamanho == registros[i].tamanho && a.hash == registros[i].hash) {
+                origem[i] = it->second;
+                registros[i].palavras = a.palavras;
+                return;
+            }
+        }
+        auto guardar = [&](std::string_view p) { return arenas[t].guardar(p); };
+        contar_faixa(arquivo.dados(), 0, arquivo.tamanho(), tamanho_minimo, [&](std::string_view p) {
+            ++registros[i].palavras;
+            tabelas[i].somar(p, hash_palavra(p), 1, guardar);
+        });
+    });
+
+    // Ocorrências dos arquivos recontados, ordenadas por palavra e arquivo.
+    struct Nova {
+        std::string_view palavra;
+        std::uint32_t arquivo;
+        std::uint64_t contagem;
+    };
+    std::vector<Nova> novas;
+    size_t recontados = 0;
+    for (size_t i : pendentes) {
+        if (origem[i] != NENHUM) continue;
+        ++recontados;
+        tabelas[i].para_cada([&](const TabelaPalavras::Entrada& e) {
+            novas.push_back(Nova{e.chave, static_cast<std::uint32_t>(i), e.contagem});
+        });
+    }
+    std::sort(std::execution::par, novas.begin(), novas.end(), [](const Nova& a, const Nova& b) {
+        return std::tie(a.palavra, a.arquivo) < std::tie(b.palavra, b.arquivo);
+    });
+
+    // Posição, no índice novo, de cada arquivo antigo reaproveitado.
+    constexpr std::uint32_t DESCARTADO = UINT32_MAX;
+    std::vector<std::uint32_t> destino(antigo ? antigo->num_arquivos() : 0, DESCARTADO);
+    for (size_t i = 0; i < n; ++i)
+        if (origem[i] != NENHUM) destino[origem[i]] = i;
+
+    indice::NovoIndice novo;
+    novo.tamanho_minimo = tamanho_minimo;
+    for (size_t i = 0; i < n; ++i) {
+        registros[i].caminho = novo.guardar(entradas[i].caminho);
+        registros[i].tamanho_caminho = entradas[i].caminho.size();
+    }
+    novo.arquivos = std::move(registros);
+
+    // Intercala o vocabulário antigo com as palavras novas, ambos em ordem.
+    const size_t total_antigas = antigo ? antigo->num_palavras() : 0;
+    std::vector<indice::Ocorrencia> lista;
+    for (size_t a = 0, b = 0; a < total_antigas || b < novas.size(); ) {
+        std::string_view palavra = a < total_antigas ? antigo->chave(antigo->palavra(a)) : std::string_view{};
+        if (a == total_antigas || (b < novas.size() && novas[b].palavra < palavra)) palavra = novas[b].palavra;
+        lista.clear();
+        if (a < total_antigas && antigo->chave(antigo->palavra(a)) == palavra) {
+            const indice::RegistroPalavra& r = antigo->palavra(a++);
+            const indice::Ocorrencia* o = antigo->ocorrencias(r);
+            for (size_t k = 0; k < r.num_ocorrencias; ++k)
+                if (destino[o[k].arquivo] != DESCARTADO)
+                    lista.push_back(indice::Ocorrencia{destino[o[k].arquivo], 0, o[k].contagem});
+        }
+        for (; b < novas.size() && novas[b].palavra == palavra; ++b)
+            lista.push_back(indice::Ocorrencia{novas[b].arquivo, 0, novas[b].contagem});
+        if (lista.empty()) continue;  // só ocorria em arquivos alterados ou removidos
+        std::sort(lista.begin(), lista.end(), [](const indice::Ocorrencia& x, const indice::Ocorrencia& y) {
+            return x.arquivo < y.arquivo;
+        });
+        std::uint64_t total = 0;
+        for (const auto& o : lista) total += o.contagem;
+        novo.palavras.push_back(indice::RegistroPalavra{novo.guardar(palavra), static_cast<std::uint32_t>(palavra.size()),
+                                                        static_cast<std::uint32_t>(lista.size()),
+                                                        novo.ocorrencias.size(), total});
+        novo.ocorrencias.insert(novo.ocorrencias.end(), lista.begin(), lista.end());
+    }
+
+    size_t removidos = antigo ? antigo->num_arquivos() - mantidos : 0;
+    antigo.reset();
+    indice::escrever_indice(caminho_indice, novo);
+    std::cerr << "Indice " << caminho_indice << ": " << n << " arquivos (" << recontados << " recontados, "
+              << n - recontados << " reaproveitados, " << removidos << " removidos), "
+              << novo.palavras.size() << " palavras\n";
+}
+
+// Consulta as palavras no índice mapeado, sem carregá-lo: para cada uma,
+// imprime o total e a contagem em cada arquivo onde ocorre.
+void consultar_indice(const std::string& caminho, const std::vector<std::string>& palavras) {
+    indice::IndiceMapeado mapa(caminho);
+    for (const std::string& palavra : palavras) {
+        // A consulta passa pela mesma normalização do texto ("Época" busca "época").
+        std::string normal(palavra.size(), ' ');
+        normalizar(palavra.data(), normal.data(), palavra.size());
+        std::string_view chave = normal;
+        chave.remove_prefix(std::min(chave.find_first_not_of(' '), chave.size()));
+        chave = chave.substr(0, chave.find(' '));
+
+        const indice::RegistroPalavra* r = mapa.buscar(chave);
+        std::cout << chave << ": " << (r ? r->total : 0) << '\n';
+        for (size_t k = 0; r && k < r->num_ocorrencias; ++k) {
+            const indice::Ocorrencia& o = mapa.ocorrencias(*r)[k];
+            std::cout << "  " << mapa.caminho(mapa.arquivo(o.arquivo)) << ": " << o.contagem << '\n';
+        }
+    }
+}
+
+// Imprime, em ordem decrescente, as `k` palavras mais frequentes de acordo com
+// os resumos Space-Saving das threads e os limites de erro das contagens.
+void imprimir_topo_aproximado(const std::vector<ResumoEspacoEconomico>& resumos, size_t k) {
+    size_t capacidade = resumos.front().capacidade(), total = 0, limite = 0;
+    for (const auto& r : resumos) {
+        total += r.total();
+        limite += r.total() / r.capacidade();
+    }
+    std::vector<ResumoEspacoEconomico::Contador> topo = ResumoEspacoEconomico::mesclar(resumos, capacidade);
+    // Uma palavra está garantidamente entre as k primeiras se a sua contagem
+    // mínima supera a estimativa da primeira palavra que ficou de fora.
+    size_t corte = topo.size() > k ? topo[k].contagem : 0, garantidas = 0;
+    for (size_t i = 0; i < std::min(k, topo.size()); ++i) {
+        const auto& c = topo[i];
+        garantidas += c.contagem - c.erro > corte;
+        std::cout << c.palavra << ": " << c.contagem << " (erro <= " << c.erro << ")\n";
+    }
+    std::cout.flush();
+    std::cerr << "Top-" << k << " aproximado: " << total << " palavras, " << resumos.size() << " resumos de "
+              << capacidade << " contadores, erro maximo por contagem " << limite << ", "
+              << garantidas << " posicoes garantidas\n";
 }
 
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && std::string_view(argv[1]).starts_with("--consultar=")) {
+        try {
+            consultar_indice(argv[1] + 12, std::vector<std::string>(argv + 2, argv + argc));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " <arquivo.txt|diretorio|@lista|-> <tamanho_minimo_palavra>"
+                  << " [--fluxo[=MB]] [--topo=K [--aproximado[=contadores]]] [--indice=arquivo]\n"
+                  << "     " << argv[0] << " --consultar=<indice> <palavra>...\n";
+        return 1;
+    }
+
+    std::string caminho = argv[1];
+    size_t tamanho_minimo = std::stoul(argv[2]);
+    size_t tamanho_trecho = 0;  // 0: arquivo inteiro mapeado em memória
+    size_t topo = 0;            // 0: imprime o vocabulário inteiro, sem ordem
+    size_t contadores = 0;      // > 0: top-K aproximado com Space-Saving
+    bool aproximado = false;
+    std::string caminho_indice;
+    for (int i = 3; i < argc; ++i) {
+        std::string opcao = argv[i];
+        if (opcao == "--fluxo") tamanho_trecho = size_t{1} << 20;
+        else if (opcao.starts_with("--fluxo=")) tamanho_trecho = std::max<size_t>(std::stoul(opcao.substr(8)), 1) << 20;
+        else if (opcao.starts_with("--topo=")) topo = std::stoul(opcao.substr(7));
+        else if (opcao == "--aproximado") aproximado = true;
+        else if (opcao.starts_with("--aproximado=")) {
+            aproximado = true;
+            contadores = std::stoul(opcao.substr(13));
+        } else if (opcao.starts_with("--indice=")) caminho_indice = opcao.substr(9);
+        else {
+            std::cerr << "Opcao desconhecida: " << opcao << '\n';
+            return 1;
+        }
+    }
+    if (aproximado && topo == 0) {
+        std::cerr << "--aproximado exige --topo=K\n";
+        return 1;
+    }
+    if (!caminho_indice.empty() && (tamanho_trecho > 0 || topo > 0 || caminho == "-")) {
+        std::cerr << "--indice conta arquivos mapeados e nao combina com --fluxo, --topo ou a entrada padrao\n";
+        return 1;
+    }
+    // Dez contadores por posição pedida mantêm o erro pequeno nas primeiras posições.
+    if (aproximado) contadores = std::max(contadores ? contadores : 10 * topo, topo);
+    if (caminho == "-" && tamanho_trecho == 0) tamanho_trecho = size_t{1} << 20;
+
+    try {
+        const size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::string> excluir;
+        if (!caminho_indice.empty()) excluir = {caminho_indice, caminho_indice + ".tmp"};
+        std::vector<Entrada> entradas = caminho == "-" ? std::vector<Entrada>{Entrada{caminho}} : listar_entradas(caminho, excluir);
+        if (!caminho_indice.empty()) {
+            atualizar_indice(caminho_indice, entradas, tamanho_minimo, num_threads);
+            return 0;
+        }
+
+        // Quatro fatias por thread, no mínimo, equilibram a agregação paralela.
+        // No modo aproximado, cada thread tem apenas um resumo de memória fixa.
+        const int bits_fatia = std::bit_width(4 * num_threads - 1);
+        std::vector<TabelaFatiada> mapas_parciais(aproximado ? 0 : num_threads, TabelaFatiada(bits_fatia));
+        std::vector<Arena> arenas(aproximado ? 0 : num_threads);
+        std::vector<ResumoEspacoEconomico> resumos;
+        if (aproximado) {
+            resumos.reserve(num_threads);
+            for (size_t t = 0; t < num_threads; ++t) resumos.emplace_back(contadores);
+        }
+
+        // Conta as palavras da faixa [inicio, fim) de `texto` nas estruturas da thread `t`.
+        auto processar = [&](size_t t, const char* texto, size_t inicio, size_t fim) {
+            if (aproximado) {
+                contar_faixa(texto, inicio, fim, tamanho_minimo,
+                             [&](std::string_view p) { resumos[t].contar(p); });
+            } else {
+                auto guardar = [&](std::string_view p) { return arenas[t].guardar(p); };
+                contar_faixa(texto, inicio, fim, tamanho_minimo,
+                             [&](std::string_view p) { mapas_parciais[t].somar(p, 1, guardar); });
+            }
+        };
+
+        if (tamanho_trecho > 0) {
+            // Os arquivos são lidos um após o outro, cada um por todas as threads.
+            for (const Entrada& entrada : entradas) {
+                int fd = entrada.caminho == "-" ? STDIN_FILENO : ::open(entrada.caminho.c_str(), O_RDONLY);
+                if (fd < 0) throw std::runtime_error("Erro ao abrir o arquivo " + entrada.caminho + ".");
+                ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+                contar_fluxo(fd, tamanho_trecho, num_threads, [&](size_t t, const char* dados, size_t tamanho) {
+                    processar(t, dados, 0, tamanho);
+                });
+                if (fd != STDIN_FILENO) ::close(fd);
+            }
+        } else if (entradas.size() > 1) {
+            // Vários arquivos: cada thread conta arquivos inteiros.
+            std::vector<size_t> todos(entradas.size());
+            for (size_t i = 0; i < todos.size(); ++i) todos[i] = i;
+            distribuir_arquivos(entradas, todos, num_threads, [&](size_t t, size_t i) {
+                ArquivoMapeado arquivo(entradas[i].caminho.c_str());
+                processar(t, arquivo.dados(), 0, arquivo.tamanho());
+            });
+        } else if (!entradas.empty()) {
+            ArquivoMapeado arquivo(entradas[0].caminho.c_str());
+            const char* texto = arquivo.dados();
+            std::vector<std::pair<size_t, size_t>> blocos = dividir_em_faixas(texto, arquivo.tamanho(), num_threads);
+
+            std::for_each(std::execution::par, blocos.begin(), blocos.end(),
+                [&](const std::pair<size_t, size_t>& intervalo) {
+                    size_t idx = &intervalo - &blocos[0]; // índice do bloco
+                    processar(idx, texto, intervalo.first, intervalo.second);
+                });
+        }
+
+        if (aproximado) {
+            imprimir_topo_aproximado(resumos, topo);
+        } else {
+            std::vector<TabelaPalavras> resultado_final(size_t{1} << bits_fatia);
+            std::for_each(std::execution::par, resultado_final.begin(), resultado_final.end(),
+                [&](TabelaPalavras& fatia) {
+                    agregar_fatia(fatia, mapas_parciais, &fatia - &resultado_final[0]);
+                });
+
+            if (topo > 0) {
+                for (const auto& e : maiores_exatas(resultado_final, topo))
+                    std::cout << e.chave << ": " << e.contagem << '\n';
+            } else {
+                for (const auto& fatia : resultado_final) {
+                    fatia.para_cada([](const TabelaPalavras::Entrada& e) {
+                        std::cout << e.chave << ": " << e.contagem << '\n';
+                    });
+                }
+            }
+            std::cout.flush();
+        }
+
+        struct rusage uso;
+        ::getrusage(RUSAGE_SELF, &uso);
+        std::cerr << "Alocacoes: " << total_alocacoes << " (" << bytes_alocados << " bytes), "
+                  << "pico de memoria residente: " << uso.ru_maxrss << " KB\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+--------------------------------------
+Este programa faz parte do material que acompanha o curso "Programação Multithread: Modelos e Abstrações em Linguagens Contemporâneas", ministrado por "Gerson Geraldo H. Cavalheiro, Alexandro Baldassin, André Rauber Du Bois" nas Jornadas de Atualização de Informática (JAI 2024) e se encontra disponível em https://github.com/GersonCavalheiro/JAI2025. Ao utilizar, referenciar a fonte.
+--------------------------------------
+
+Descrição do Programa
+
+Este programa, escrito em C++20, gera um corpus de texto sintético para medir a contagem de palavras (`conta_palavras_blocos` e `conta_palavras_bench`). O texto é formado por frases de palavras sorteadas de um vocabulário artificial segundo a lei de Zipf: a palavra de posição r aparece com frequência proporcional a 1/r^s, como nas línguas naturais. As palavras são compostas de sílabas do português, incluindo letras acentuadas em UTF-8, e a primeira palavra de cada frase começa com maiúscula (também acentuada, como "Ção" ou "Época"), de modo que a normalização e o vocabulário sejam exercitados como em um texto real. As frases têm vírgulas, terminam em ponto e são agrupadas em linhas.
+
+A saída é determinística: a mesma semente e o mesmo tamanho produzem sempre o mesmo arquivo, byte a byte, qualquer que seja o número de threads.
+
+Parâmetros de Lançamento
+
+O programa exige dois argumentos na linha de comando:
+
+1. Tamanho do corpus em megabytes (aceita frações, como 0.5, e valores de dezenas de milhares para dezenas de gigabytes).
+2. Arquivo de saída, ou `-` para a saída padrão.
+
+E aceita, opcionalmente:
+
+- `--vocabulario=N`: número de palavras do vocabulário (padrão 100000).
+- `--expoente=s`: expoente da lei de Zipf (padrão 1.0).
+- `--semente=S`: semente do gerador pseudoaleatório (padrão 1).
+
+Exemplo de execução:
+
+./conta_palavras_corpus 1024 corpus.txt --vocabulario=500000
+
+Esse comando gera 1 GiB de texto com até 500 mil palavras distintas.
+
+Recursos de Programação Concorrente Utilizados
+
+- `std::async` com `std::launch::async`: o corpus é dividido em blocos de 4 MiB, gerados em paralelo, um lote de blocos por vez, e gravados na ordem pela thread principal à medida que os `std::future`s ficam prontos.
+- Determinismo: cada bloco tem o seu próprio gerador (splitmix64), semeado pela semente global e pelo número do bloco, e termina em uma fronteira de palavra completada com espaços. O conteúdo de um bloco não depende dos demais nem da ordem de execução das tarefas.
+*/
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Gerador pseudoaleatório splitmix64: pequeno, rápido e igual em qualquer plataforma.
+struct Gerador {
+    std::uint64_t estado;
+
+    std::uint64_t proximo() {
+        std::uint64_t z = (estado += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // Inteiro em [0, n).
+    std::uint64_t ate(std::uint64_t n) { return proximo() % n; }
+    // Real em [0, 1).
+    double uniforme() { return (proximo() >> 11) * 0x1.0p-53; }
+};
+
+// Vocabulário artificial e a distribuição de Zipf sobre ele.
+class Vocabulario {
+    std::vector<std::string> palavras;
+    std::vector<std::string> maiusculas;  // a mesma palavra com a inicial maiúscula
+    // Tabela de apelidos (método de Walker/Vose): sorteio em tempo constante.
+    std::vector<double> limiar;
+    std::vector<std::uint32_t> apelido;
+
+    // Maiúscula da primeira letra: ASCII ou Latin-1 minúsculo em UTF-8 (C3 A0-BE).
+    static std::string capitalizar(std::string p) {
+        if (p[0] >= 'a' && p[0] <= 'z') p[0] -= 0x20;
+        else if (static_cast<unsigned char>(p[0]) == 0xC3 && p.size() > 1) p[1] -= 0x20;
+        return p;
+    }
+
+public:
+    Vocabulario(size_t n, double expoente, std::uint64_t semente) {
+        static const char* const silabas[] = {
+            "a", "e", "o", "de", "da", "do", "que", "ma", "pa", "ra", "to", "ca", "ne", "lu", "mi",
+            "sol", "mar", "flor", "bre", "tri", "gan", "ver", "sen", "com", "por",
+            "ção", "ções", "ão", "ões", "lã", "mãe", "pé", "fé", "lá", "vó", "só", "crê", "pôr",
+            "éter", "água", "ínte", "óleo", "ún", "ça", "ço", "çu", "ü", "à", "é", "ê",
+        };
+        constexpr size_t total_silabas = sizeof silabas / sizeof silabas[0];
+        Gerador g{semente * 0x2545F4914F6CDD1Dull};
+        palavras.reserve(n);
+        maiusculas.reserve(n);
+        std::vector<double> peso(n);
+        double soma = 0;
+        for (size_t r = 0; r < n; ++r) {
+            // Palavras mais frequentes tendem a ser mais curtas.
+            size_t partes = 1 + g.ate(1 + std::min<size_t>(4, std::bit_width(r) / 4));
+            std::string p;
+            for (size_t s = 0; s < partes; ++s) p += silabas[g.ate(total_silabas)];
+            palavras.push_back(p);
+            maiusculas.push_back(capitalizar(std::move(p)));
+            peso[r] = 1.0 / std::pow(static_cast<double>(r + 1), expoente);
+            soma += peso[r];
+        }
+
+        // Cada posição fica com a sua palavra até `limiar` e cede o resto a um
+        // apelido, uma palavra cujo peso excede a média.
+        limiar.assign(n, 1.0);
+        apelido.resize(n);
+        std::vector<std::uint32_t> leves, pesadas;
+        for (size_t r = 0; r < n; ++r) {
+            peso[r] *= n / soma;
+            apelido[r] = r;
+            (peso[r] < 1.0 ? leves : pesadas).push_back(r);
+        }
+        while (!leves.empty() && !pesadas.empty()) {
+            std::uint32_t l = leves.back(), p = pesadas.back();
+            leves.pop_back();
+            limiar[l] = peso[l];
+            apelido[l] = p;
+            peso[p] -= 1.0 - peso[l];
+            if (peso[p] < 1.0) {
+                pesadas.pop_back();
+                leves.push_back(p);
+            }
+        }
+    }
+
+    size_t sortear(Gerador& g) const {
+        size_t r = g.ate(limiar.size());
+        return g.uniforme() < limiar[r] ? r : apelido[r];
+    }
+
+    const std::string& palavra(size_t r) const { return palavras[r]; }
+    const std::string& maiuscula(size_t r) const { return maiusculas[r]; }
+};
+
+// Gera o bloco `b`, com exatamente `tamanho` bytes.
+std::string gerar_bloco(const Vocabulario& vocab, std::uint64_t semente, std::uint64_t b, size_t tamanho) {
+    Gerador g{semente ^ (b * 0xD1B54A32D192ED03ull)};
+    g.proximo();
+    std::string texto;
+    texto.reserve(tamanho + 256);
+    while (texto.size() < tamanho) {
+        size_t palavras = 5 + g.ate(16);
+        for (size_t i = 0; i < palavras; ++i) {
+            size_t r = vocab.sortear(g);
+            texto += i == 0 ? vocab.maiuscula(r) : vocab.palavra(r);
+            if (i + 1 == palavras) texto += '.';
+            else if (g.ate(8) == 0) texto += ',';
+            texto += i + 1 == palavras && g.ate(4) == 0 ? '\n' : ' ';
+        }
+    }
+    // Corta na última fronteira de palavra e completa com espaços.
+    size_t corte = texto.find_last_of(" \n", tamanho - 1);
+    texto.resize(corte == std::string::npos ? 0 : corte);
+    texto.resize(tamanho, ' ');
+    if (tamanho > 0) texto.back() = '\n';
+    return texto;
+}
+
+void gravar(int fd, const std::string& texto) {
+    const char* p = texto.data();
+    size_t n = texto.size();
+    while (n > 0) {
+        ssize_t r = ::write(fd, p, n);
+        if (r < 0) throw std::runtime_error("Erro ao gravar o corpus.");
+        p += r;
+        n -= r;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " <tamanho_MB> <saida|-> [--vocabulario=N] [--expoente=s] [--semente=S]\n";
+        return 1;
+    }
+
+    const std::uint64_t tamanho = static_cast<std::uint64_t>(std::stod(argv[1]) * (1 << 20));
+    std::string saida = argv[2];
+    size_t vocabulario = 100000;
+    double expoente = 1.0;
+    std::uint64_t semente = 1;
+    for (int i = 3; i < argc; ++i) {
+        std::string opcao = argv[i];
+        if (opcao.starts_with("--vocabulario=")) vocabulario = std::max<size_t>(1, std::stoul(opcao.substr(14)));
+        else if (opcao.starts_with("--expoente=")) expoente = std::stod(opcao.substr(11));
+        else if (opcao.starts_with("--semente=")) semente = std::stoull(opcao.substr(10));
+        else {
+            std::cerr << "Opcao desconhecida: " << opcao << '\n';
+            return 1;
+        }
+    }
+
+    try {
+        int fd = saida == "-" ? STDOUT_FILENO : ::open(saida.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("Erro ao criar " + saida + ".");
+
+        const Vocabulario vocab(vocabulario, expoente, semente);
+        constexpr std::uint64_t BLOCO = 4 << 20;
+        const std::uint64_t blocos = (tamanho + BLOCO - 1) / BLOCO;
+        const std::uint64_t lote = std::max(1u, std::thread::hardware_concurrency());
+
+        for (std::uint64_t inicio = 0; inicio < blocos; inicio += lote) {
+            std::vector<std::future<std::string>> tarefas;
+            for (std::uint64_t b = inicio; b < std::min(blocos, inicio + lote); ++b) {
+                size_t n = std::min(BLOCO, tamanho - b * BLOCO);
+                tarefas.push_back(std::async(std::launch::async, gerar_bloco, std::cref(vocab), semente, b, n));
+            }
+            for (auto& t : tarefas) gravar(fd, t.get());
+        }
+        if (fd != STDOUT_FILENO) ::close(fd);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
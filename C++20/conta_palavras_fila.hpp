@@ -0,0 +1,52 @@
+/*
+Fila bloqueante de capacidade limitada, usada pelo modo em fluxo (`--fluxo`)
+da contagem de palavras.
+
+`push` bloqueia enquanto a fila está cheia e `pop` enquanto está vazia, ambos
+com um `std::mutex` e duas `std::condition_variable`s, como nos programas
+produtor/consumidor. `fechar` acorda todos os consumidores: depois dela, `pop`
+esvazia o que resta e então devolve `std::nullopt`.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <queue>
+
+template <typename T>
+class FilaLimitada {
+    std::queue<T> itens;
+    size_t capacidade;
+    bool fechada = false;
+    std::mutex mtx;
+    std::condition_variable nao_cheia, nao_vazia;
+
+public:
+    explicit FilaLimitada(size_t capacidade) : capacidade(capacidade) {}
+
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        nao_cheia.wait(lock, [&] { return itens.size() < capacidade; });
+        itens.push(std::move(item));
+        nao_vazia.notify_one();
+    }
+
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        nao_vazia.wait(lock, [&] { return !itens.empty() || fechada; });
+        if (itens.empty()) return std::nullopt;
+        T item = std::move(itens.front());
+        itens.pop();
+        nao_cheia.notify_one();
+        return item;
+    }
+
+    void fechar() {
+        std::lock_guard<std::mutex> lock(mtx);
+        fechada = true;
+        nao_vazia.notify_all();
+    }
+};
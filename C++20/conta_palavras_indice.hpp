@@ -0,0 +1,198 @@
+/*
+Índice persistente da contagem de palavras (`--indice=arquivo`).
+
+O índice é um único arquivo binário, pensado para ser mapeado em memória
+(`mmap`) e consultado sem ser carregado. Todas as seções são vetores de
+registros de tamanho fixo, alinhados a 8 bytes, na ordem:
+
+- `Cabecalho`: identificação, versão, tamanho mínimo de palavra usado na
+  contagem e o número de registros de cada seção.
+- `RegistroArquivo`, um por arquivo de entrada: caminho, tamanho, data de
+  modificação e um hash do conteúdo (a "impressão digital" do arquivo), além do
+  número de palavras contadas nele.
+- `RegistroPalavra`, um por palavra distinta, em ordem crescente de bytes: a
+  contagem total e o trecho de `Ocorrencia`s da palavra. Uma consulta é uma
+  busca binária nesta seção, que só toca as páginas visitadas.
+- `Ocorrencia`: pares (arquivo, contagem), agrupados por palavra e ordenados
+  pelo arquivo.
+- O texto das palavras e dos caminhos, referenciado pelos registros.
+
+`escrever_indice` grava um índice novo em um arquivo temporário e o renomeia
+sobre o antigo, de modo que um leitor nunca vê um índice pela metade.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace indice {
+
+constexpr char MAGICA[8] = {'C', 'P', 'I', 'N', 'D', 'I', 'C', 'E'};
+constexpr std::uint64_t VERSAO = 1;
+
+struct Cabecalho {
+    char magica[8];
+    std::uint64_t versao;
+    std::uint64_t tamanho_minimo;
+    std::uint64_t num_arquivos;
+    std::uint64_t num_palavras;
+    std::uint64_t num_ocorrencias;
+    std::uint64_t bytes_texto;
+};
+
+struct RegistroArquivo {
+    std::uint64_t caminho;          // posição no texto
+    std::uint64_t tamanho_caminho;
+    std::uint64_t tamanho;          // bytes do arquivo
+    std::int64_t modificacao;       // st_mtim em nanossegundos
+    std::uint64_t hash;             // hash do conteúdo
+    std::uint64_t palavras;         // palavras contadas no arquivo
+};
+
+struct RegistroPalavra {
+    std::uint64_t texto;            // posição no texto
+    std::uint32_t tamanho;
+    std::uint32_t num_ocorrencias;
+    std::uint64_t primeira;         // índice da primeira `Ocorrencia`
+    std::uint64_t total;
+};
+
+struct Ocorrencia {
+    std::uint32_t arquivo;
+    std::uint32_t reservado;
+    std::uint64_t contagem;
+};
+
+// Índice aberto somente para leitura e mapeado em memória.
+class IndiceMapeado {
+    const char* base = nullptr;
+    size_t tamanho_ = 0;
+    const Cabecalho* cabecalho = nullptr;
+    const RegistroArquivo* arquivos_ = nullptr;
+    const RegistroPalavra* palavras_ = nullptr;
+    const Ocorrencia* ocorrencias_ = nullptr;
+    const char* texto = nullptr;
+
+public:
+    explicit IndiceMapeado(const std::string& caminho) {
+        int fd = ::open(caminho.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            if (fd >= 0) ::close(fd);
+            throw std::runtime_error("Erro ao abrir o indice " + caminho + ".");
+        }
+        tamanho_ = st.st_size;
+        if (tamanho_ >= sizeof(Cabecalho)) {
+            void* mapa = ::mmap(nullptr, tamanho_, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapa != MAP_FAILED) base = static_cast<const char*>(mapa);
+        }
+        ::close(fd);
+        if (!base) throw std::runtime_error("Erro ao mapear o indice " + caminho + ".");
+
+        cabecalho = reinterpret_cast<const Cabecalho*>(base);
+        const auto& c = *cabecalho;
+        size_t esperado = sizeof(Cabecalho) + c.num_arquivos * sizeof(RegistroArquivo)
+                        + c.num_palavras * sizeof(RegistroPalavra)
+                        + c.num_ocorrencias * sizeof(Ocorrencia) + c.bytes_texto;
+        if (std::memcmp(c.magica, MAGICA, sizeof MAGICA) != 0 || c.versao != VERSAO || esperado != tamanho_) {
+            ::munmap(const_cast<char*>(base), tamanho_);
+            throw std::runtime_error("Indice invalido: " + caminho + ".");
+        }
+        arquivos_ = reinterpret_cast<const RegistroArquivo*>(base + sizeof(Cabecalho));
+        palavras_ = reinterpret_cast<const RegistroPalavra*>(arquivos_ + c.num_arquivos);
+        ocorrencias_ = reinterpret_cast<const Ocorrencia*>(palavras_ + c.num_palavras);
+        texto = reinterpret_cast<const char*>(ocorrencias_ + c.num_ocorrencias);
+    }
+    ~IndiceMapeado() { ::munmap(const_cast<char*>(base), tamanho_); }
+    IndiceMapeado(const IndiceMapeado&) = delete;
+    IndiceMapeado& operator=(const IndiceMapeado&) = delete;
+
+    size_t tamanho_minimo() const { return cabecalho->tamanho_minimo; }
+    size_t num_arquivos() const { return cabecalho->num_arquivos; }
+    size_t num_palavras() const { return cabecalho->num_palavras; }
+
+    const RegistroArquivo& arquivo(size_t i) const { return arquivos_[i]; }
+    const RegistroPalavra& palavra(size_t i) const { return palavras_[i]; }
+
+    std::string_view caminho(const RegistroArquivo& a) const { return {texto + a.caminho, a.tamanho_caminho}; }
+    std::string_view chave(const RegistroPalavra& p) const { return {texto + p.texto, p.tamanho}; }
+    const Ocorrencia* ocorrencias(const RegistroPalavra& p) const { return ocorrencias_ + p.primeira; }
+
+    // Busca binária no vocabulário ordenado.
+    const RegistroPalavra* buscar(std::string_view alvo) const {
+        const RegistroPalavra* fim = palavras_ + num_palavras();
+        const RegistroPalavra* p = std::lower_bound(palavras_, fim, alvo,
+            [&](const RegistroPalavra& r, std::string_view v) { return chave(r) < v; });
+        return p != fim && chave(*p) == alvo ? p : nullptr;
+    }
+};
+
+// Conteúdo de um índice a ser gravado; as palavras devem estar em ordem.
+struct NovoIndice {
+    std::uint64_t tamanho_minimo = 0;
+    std::vector<RegistroArquivo> arquivos;
+    std::vector<RegistroPalavra> palavras;
+    std::vector<Ocorrencia> ocorrencias;
+    std::string texto;
+
+    std::uint64_t guardar(std::string_view s) {
+        std::uint64_t posicao = texto.size();
+        texto.append(s);
+        return posicao;
+    }
+};
+
+inline void escrever_tudo(int fd, const void* dados, size_t n) {
+    const char* p = static_cast<const char*>(dados);
+    while (n > 0) {
+        ssize_t r = ::write(fd, p, n);
+        if (r < 0) throw std::runtime_error("Erro ao gravar o indice.");
+        p += r;
+        n -= r;
+    }
+}
+
+inline void escrever_indice(const std::string& caminho, const NovoIndice& novo) {
+    Cabecalho c{};
+    std::memcpy(c.magica, MAGICA, sizeof MAGICA);
+    c.versao = VERSAO;
+    c.tamanho_minimo = novo.tamanho_minimo;
+    c.num_arquivos = novo.arquivos.size();
+    c.num_palavras = novo.palavras.size();
+    c.num_ocorrencias = novo.ocorrencias.size();
+    c.bytes_texto = novo.texto.size();
+
+    std::string temporario = caminho + ".tmp";
+    int fd = ::open(temporario.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Erro ao criar " + temporario + ".");
+    try {
+        escrever_tudo(fd, &c, sizeof c);
+        escrever_tudo(fd, novo.arquivos.data(), novo.arquivos.size() * sizeof(RegistroArquivo));
+        escrever_tudo(fd, novo.palavras.data(), novo.palavras.size() * sizeof(RegistroPalavra));
+        escrever_tudo(fd, novo.ocorrencias.data(), novo.ocorrencias.size() * sizeof(Ocorrencia));
+        escrever_tudo(fd, novo.texto.data(), novo.texto.size());
+        if (::fsync(fd) != 0) throw std::runtime_error("Erro ao gravar o indice.");
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temporario.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (std::rename(temporario.c_str(), caminho.c_str()) != 0)
+        throw std::runtime_error("Erro ao substituir o indice " + caminho + ".");
+}
+
+}  // namespace indice
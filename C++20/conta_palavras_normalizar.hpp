@@ -0,0 +1,147 @@
+/*
+Normalização do texto para a contagem de palavras, ciente de UTF-8.
+
+`normalizar` copia `n` bytes de `entrada` para `saida` trocando cada byte
+separador por um espaço e convertendo letras para minúsculas. O tamanho é
+preservado, de modo que a saída pode ser separada em palavras apenas por
+espaços. As regras são:
+
+- ASCII: pontuação e espaços (`ispunct`/`isspace` na localidade "C") separam
+  palavras; `A`-`Z` viram `a`-`z`.
+- Suplemento Latin-1 em UTF-8 (`C2 xx` e `C3 xx`): as maiúsculas acentuadas
+  U+00C0-U+00DE viram as minúsculas correspondentes (U+00E0-U+00FE), exceto o
+  sinal de multiplicação; `×`, `÷` e os símbolos U+0080-U+00BF (espaço não
+  separável, `«`, `»`, `¿`, `§`, ...) separam palavras, exceto as letras `ª`,
+  `µ` e `º`.
+- Pontuação geral U+2000-U+203F (`E2 80 xx`): espaços tipográficos, travessões
+  e aspas curvas (`–`, `—`, `‘`, `’`, `“`, `”`, `…`, ...) separam palavras,
+  exceto os juntores de largura zero U+200C e U+200D.
+- Demais bytes, incluindo outras sequências UTF-8, fazem parte das palavras.
+
+O texto é tratado 32 bytes por vez com AVX2 ou 16 por vez com SSE2. Em cada
+bloco, apenas os bytes não ASCII (raros em textos comuns, mesmo em português)
+passam depois pelo caminho escalar, que decodifica a sequência UTF-8.
+
+Uma sequência cortada pelo fim da entrada é mantida sem alteração: quem chama
+deve reprocessá-la junto com o restante da palavra.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace normalizacao {
+
+inline bool separador_ascii(unsigned char c) {
+    return (c >= 0x21 && c <= 0x2F) || (c >= 0x3A && c <= 0x40) || (c >= 0x5B && c <= 0x60)
+        || (c >= 0x7B && c <= 0x7E) || (c >= 0x09 && c <= 0x0D) || c == 0x20;
+}
+
+// Trata o byte `i`, ASCII ou início de sequência UTF-8; devolve quantos bytes consumiu.
+inline size_t escalar(const unsigned char* in, unsigned char* out, size_t i, size_t n) {
+    unsigned char c = in[i];
+    if (c < 0x80) {
+        out[i] = separador_ascii(c) ? ' ' : (c >= 'A' && c <= 'Z' ? c + 0x20 : c);
+        return 1;
+    }
+    if ((c == 0xC2 || c == 0xC3) && i + 1 < n && (in[i + 1] & 0xC0) == 0x80) {
+        unsigned char d = in[i + 1];
+        bool separa = c == 0xC2 ? d != 0xAA && d != 0xB5 && d != 0xBA : d == 0x97 || d == 0xB7;
+        if (separa) {
+            out[i] = out[i + 1] = ' ';
+        } else {
+            out[i] = c;
+            out[i + 1] = c == 0xC3 && d <= 0x9E ? d + 0x20 : d;
+        }
+        return 2;
+    }
+    if (c == 0xE2 && i + 2 < n && in[i + 1] == 0x80 && (in[i + 2] & 0xC0) == 0x80) {
+        unsigned char d = in[i + 2];
+        bool separa = d != 0x8C && d != 0x8D;  // ZWNJ e ZWJ unem partes de uma palavra
+        for (size_t k = 0; k < 3; ++k) out[i + k] = separa ? ' ' : in[i + k];
+        return 3;
+    }
+    out[i] = c;
+    return 1;
+}
+
+#if defined(__x86_64__)
+// Depois que um bloco foi gravado pelo caminho vetorial (que copia os bytes não
+// ASCII sem alteração), trata pelo caminho escalar os bytes não ASCII cujas
+// posições, a partir de `i`, estão em `mascara`. Devolve a primeira posição
+// ainda não tratada, que pode passar do fim do bloco em até dois bytes.
+inline size_t corrigir_nao_ascii(const unsigned char* in, unsigned char* out, size_t i,
+                                 std::uint32_t mascara, size_t n) {
+    size_t livre = i;
+    for (; mascara; mascara &= mascara - 1) {
+        size_t j = i + __builtin_ctz(mascara);
+        if (j >= livre) livre = j + escalar(in, out, j, n);
+    }
+    return livre;
+}
+
+// x em [lo, hi], byte a byte, sem sinal.
+inline __m128i no_intervalo(__m128i x, char lo, char hi) {
+    __m128i d = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(static_cast<char>(hi - lo))), d);
+}
+
+// Processa um bloco de 16 bytes; os bytes não ASCII saem inalterados.
+inline __m128i bloco_sse2(__m128i x) {
+    __m128i sep = _mm_or_si128(
+        _mm_or_si128(no_intervalo(x, 0x21, 0x2F), no_intervalo(x, 0x3A, 0x40)),
+        _mm_or_si128(_mm_or_si128(no_intervalo(x, 0x5B, 0x60), no_intervalo(x, 0x7B, 0x7E)),
+                     _mm_or_si128(no_intervalo(x, 0x09, 0x0D), _mm_cmpeq_epi8(x, _mm_set1_epi8(0x20)))));
+    __m128i baixa = _mm_or_si128(x, _mm_and_si128(no_intervalo(x, 'A', 'Z'), _mm_set1_epi8(0x20)));
+    return _mm_or_si128(_mm_andnot_si128(sep, baixa), _mm_and_si128(sep, _mm_set1_epi8(' ')));
+}
+
+[[gnu::target("avx2"), gnu::always_inline]] inline __m256i no_intervalo(__m256i x, char lo, char hi) {
+    __m256i d = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(static_cast<char>(hi - lo))), d);
+}
+
+[[gnu::target("avx2")]] inline size_t blocos_avx2(const unsigned char* in, unsigned char* out, size_t n) {
+    size_t i = 0;
+    while (i + 32 <= n) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i sep = _mm256_or_si256(
+            _mm256_or_si256(no_intervalo(x, 0x21, 0x2F), no_intervalo(x, 0x3A, 0x40)),
+            _mm256_or_si256(_mm256_or_si256(no_intervalo(x, 0x5B, 0x60), no_intervalo(x, 0x7B, 0x7E)),
+                            _mm256_or_si256(no_intervalo(x, 0x09, 0x0D),
+                                            _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x20)))));
+        __m256i baixa = _mm256_or_si256(x, _mm256_and_si256(no_intervalo(x, 'A', 'Z'), _mm256_set1_epi8(0x20)));
+        __m256i r = _mm256_blendv_epi8(baixa, _mm256_set1_epi8(' '), sep);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+        std::uint32_t nao_ascii = _mm256_movemask_epi8(x);
+        i = nao_ascii ? std::max(i + 32, corrigir_nao_ascii(in, out, i, nao_ascii, n)) : i + 32;
+    }
+    return i;
+}
+#endif
+
+}  // namespace normalizacao
+
+inline void normalizar(const char* entrada, char* saida, size_t n) {
+    using namespace normalizacao;
+    const auto* in = reinterpret_cast<const unsigned char*>(entrada);
+    auto* out = reinterpret_cast<unsigned char*>(saida);
+    size_t i = 0;
+#if defined(__x86_64__)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) i = blocos_avx2(in, out, n);
+    while (i + 16 <= n) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), bloco_sse2(x));
+        std::uint32_t nao_ascii = _mm_movemask_epi8(x);
+        i = nao_ascii ? std::max(i + 16, corrigir_nao_ascii(in, out, i, nao_ascii, n)) : i + 16;
+    }
+#endif
+    while (i < n) i += escalar(in, out, i, n);
+}
@@ -0,0 +1,160 @@
+/*
+Tabela de espalhamento plana para a contagem de palavras.
+
+`TabelaPalavras` usa endereçamento aberto com sondagem linear por grupos de
+16 posições, no estilo das "Swiss tables": um vetor de bytes de controle guarda,
+para cada posição, 7 bits do hash da chave (ou a marca de posição vazia), e as
+entradas (hash completo, chave e contagem) ficam em um vetor contíguo. Uma
+busca compara os 16 bytes de controle de um grupo de uma só vez (SSE2, quando
+disponível) e só visita as entradas cujo byte coincide; o hash guardado evita
+comparar chaves diferentes e dispensa recalcular hashes ao crescer.
+
+`TabelaFatiada` divide as chaves de uma thread em fatias pelos bits altos do
+hash. Como todas as threads usam a mesma divisão, a fatia `f` do resultado
+final depende apenas das fatias `f` das tabelas parciais, e a agregação pode
+ser feita em paralelo, uma fatia por tarefa, sem travas.
+*/
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+inline std::uint64_t hash_palavra(std::string_view palavra) {
+    return std::hash<std::string_view>{}(palavra);
+}
+
+class TabelaPalavras {
+public:
+    struct Entrada {
+        std::uint64_t hash;
+        std::string_view chave;
+        size_t contagem;
+    };
+
+private:
+    static constexpr size_t GRUPO = 16;
+    static constexpr std::uint8_t VAZIO = 0x80;
+
+    std::vector<std::uint8_t> controle;
+    std::vector<Entrada> entradas;
+    size_t ocupadas = 0;
+    size_t mascara_grupos = 0;
+
+    static std::uint8_t h2(std::uint64_t hash) { return hash & 0x7F; }
+
+    // Bits das posições do grupo cujo byte de controle vale `valor`.
+    static std::uint32_t coincidencias(const std::uint8_t* grupo, std::uint8_t valor) {
+#if defined(__SSE2__)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(grupo));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(valor))));
+#else
+        std::uint32_t bits = 0;
+        for (size_t i = 0; i < GRUPO; ++i) bits |= std::uint32_t{grupo[i] == valor} << i;
+        return bits;
+#endif
+    }
+
+    void alocar(size_t grupos) {
+        controle.assign(grupos * GRUPO, VAZIO);
+        entradas.assign(grupos * GRUPO, Entrada{});
+        mascara_grupos = grupos - 1;
+        ocupadas = 0;
+    }
+
+    // Posição de `chave` ou, se ausente, a posição vazia onde ela deve entrar.
+    size_t procurar(std::string_view chave, std::uint64_t hash, bool& encontrada) const {
+        std::uint8_t marca = h2(hash);
+        for (size_t g = (hash >> 7) & mascara_grupos; ; g = (g + 1) & mascara_grupos) {
+            const std::uint8_t* grupo = controle.data() + g * GRUPO;
+            for (std::uint32_t bits = coincidencias(grupo, marca); bits; bits &= bits - 1) {
+                size_t pos = g * GRUPO + std::countr_zero(bits);
+                if (entradas[pos].hash == hash && entradas[pos].chave == chave) {
+                    encontrada = true;
+                    return pos;
+                }
+            }
+            if (std::uint32_t vazias = coincidencias(grupo, VAZIO)) {
+                encontrada = false;
+                return g * GRUPO + std::countr_zero(vazias);
+            }
+        }
+    }
+
+    void crescer() {
+        std::vector<Entrada> antigas;
+        antigas.swap(entradas);
+        std::vector<std::uint8_t> controle_antigo;
+        controle_antigo.swap(controle);
+        alocar(std::max<size_t>(1, (mascara_grupos + 1) * 2));
+        for (size_t i = 0; i < antigas.size(); ++i) {
+            if (controle_antigo[i] == VAZIO) continue;
+            bool encontrada;
+            size_t pos = procurar(antigas[i].chave, antigas[i].hash, encontrada);
+            controle[pos] = h2(antigas[i].hash);
+            entradas[pos] = antigas[i];
+            ++ocupadas;
+        }
+    }
+
+public:
+    TabelaPalavras() { alocar(1); }
+
+    size_t tamanho() const { return ocupadas; }
+
+    // Soma `quantidade` à contagem de `chave`. Se a chave é nova, `guardar`
+    // fornece a cópia estável a ser armazenada (por exemplo, em uma arena).
+    template <typename Guardar>
+    void somar(std::string_view chave, std::uint64_t hash, size_t quantidade, Guardar&& guardar) {
+        bool encontrada;
+        size_t pos = procurar(chave, hash, encontrada);
+        if (encontrada) {
+            entradas[pos].contagem += quantidade;
+            return;
+        }
+        // Carga máxima de 7/8 mantém as sondagens curtas.
+        if ((ocupadas + 1) * 8 > controle.size() * 7) {
+            crescer();
+            pos = procurar(chave, hash, encontrada);
+        }
+        controle[pos] = h2(hash);
+        entradas[pos] = Entrada{hash, guardar(chave), quantidade};
+        ++ocupadas;
+    }
+
+    template <typename F>
+    void para_cada(F&& f) const {
+        for (size_t i = 0; i < entradas.size(); ++i)
+            if (controle[i] != VAZIO) f(entradas[i]);
+    }
+};
+
+class TabelaFatiada {
+    std::vector<TabelaPalavras> fatias_;
+    int bits_fatia;
+
+public:
+    // `bits` bits altos do hash escolhem a fatia (2^bits fatias).
+    explicit TabelaFatiada(int bits) : fatias_(size_t{1} << bits), bits_fatia(bits) {}
+
+    size_t fatia(std::uint64_t hash) const {
+        return bits_fatia ? hash >> (64 - bits_fatia) : 0;
+    }
+
+    TabelaPalavras& operator[](size_t f) { return fatias_[f]; }
+    const TabelaPalavras& operator[](size_t f) const { return fatias_[f]; }
+    size_t fatias() const { return fatias_.size(); }
+
+    template <typename Guardar>
+    void somar(std::string_view chave, size_t quantidade, Guardar&& guardar) {
+        std::uint64_t hash = hash_palavra(chave);
+        fatias_[fatia(hash)].somar(chave, hash, quantidade, guardar);
+    }
+};
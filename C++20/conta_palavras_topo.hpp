@@ -0,0 +1,182 @@
+/*
+Seleção das palavras mais frequentes para o modo `--topo=K` da contagem de
+palavras.
+
+`ResumoEspacoEconomico` implementa o algoritmo Space-Saving (Metwally, Agrawal e
+El Abbadi), usado com `--aproximado`: mantém no máximo `capacidade` contadores,
+cada um com uma palavra, a sua contagem estimada e o erro máximo da estimativa.
+Uma palavra já monitorada apenas incrementa o seu contador; uma palavra nova
+ocupa um contador livre ou, se todos estão em uso, toma o lugar da palavra de
+menor contagem `min`, herdando a contagem `min + 1` e o erro `min`. A contagem
+estimada nunca é menor que a real e a excede em no máximo o erro, que não passa
+de N/capacidade para N palavras vistas; toda palavra mais frequente que isso
+está no resumo. A memória é fixa: os contadores são alocados uma única vez, um
+heap mínimo indexado encontra o menor deles, e o índice por palavra reaproveita
+os seus nós quando um contador troca de palavra.
+
+Os resumos das threads são combinados por `mesclar` ("Mergeable Summaries", de
+Agarwal et al.): cada palavra soma as contagens e os erros dos resumos em que
+aparece e, de cada resumo cheio em que não aparece, a menor contagem dele, o
+máximo que ela poderia ter tido ali. Ficam as `capacidade` maiores somas, e o
+erro de cada uma continua limitado pela soma dos limites dos resumos.
+
+`maiores_exatas` escolhe o top-K exato da tabela final: cada fatia seleciona as
+suas K maiores entradas com `std::partial_sort`, em paralelo, e os candidatos,
+no máximo K por fatia, passam por uma última seleção.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "conta_palavras_tabela.hpp"
+
+class ResumoEspacoEconomico {
+public:
+    struct Contador {
+        std::string palavra;
+        size_t contagem = 0;
+        size_t erro = 0;
+    };
+
+    // Maior contagem primeiro; empates em ordem alfabética.
+    static bool mais_frequente(const Contador& a, const Contador& b) {
+        return a.contagem != b.contagem ? a.contagem > b.contagem : a.palavra < b.palavra;
+    }
+
+private:
+    size_t capacidade_;
+    size_t total_ = 0;
+    // Reservados na construção e nunca realocados: o índice guarda
+    // `string_view`s das palavras, que podem estar dentro dos próprios contadores.
+    std::vector<Contador> contadores;
+    std::vector<std::uint32_t> heap;   // contadores em heap mínimo por contagem
+    std::vector<std::uint32_t> lugar;  // posição de cada contador no heap
+    std::unordered_map<std::string_view, std::uint32_t> indice;
+
+    bool menor(size_t i, size_t j) const {
+        return contadores[heap[i]].contagem < contadores[heap[j]].contagem;
+    }
+
+    void trocar(size_t i, size_t j) {
+        std::swap(heap[i], heap[j]);
+        lugar[heap[i]] = i;
+        lugar[heap[j]] = j;
+    }
+
+    void subir(size_t i) {
+        for (; i > 0 && menor(i, (i - 1) / 2); i = (i - 1) / 2) trocar(i, (i - 1) / 2);
+    }
+
+    void descer(size_t i) {
+        while (true) {
+            size_t alvo = i, esq = 2 * i + 1, dir = esq + 1;
+            if (esq < heap.size() && menor(esq, alvo)) alvo = esq;
+            if (dir < heap.size() && menor(dir, alvo)) alvo = dir;
+            if (alvo == i) return;
+            trocar(i, alvo);
+            i = alvo;
+        }
+    }
+
+public:
+    explicit ResumoEspacoEconomico(size_t capacidade) : capacidade_(std::max<size_t>(1, capacidade)) {
+        contadores.reserve(capacidade_);
+        heap.reserve(capacidade_);
+        lugar.reserve(capacidade_);
+        indice.reserve(capacidade_);
+    }
+    ResumoEspacoEconomico(ResumoEspacoEconomico&&) = default;
+    ResumoEspacoEconomico(const ResumoEspacoEconomico&) = delete;
+    ResumoEspacoEconomico& operator=(const ResumoEspacoEconomico&) = delete;
+
+    size_t capacidade() const { return capacidade_; }
+    size_t total() const { return total_; }
+
+    // Menor contagem monitorada, ou 0 enquanto houver contadores livres.
+    size_t minimo() const {
+        return contadores.size() < capacidade_ ? 0 : contadores[heap[0]].contagem;
+    }
+
+    void contar(std::string_view palavra) {
+        ++total_;
+        if (auto it = indice.find(palavra); it != indice.end()) {
+            ++contadores[it->second].contagem;
+            descer(lugar[it->second]);
+            return;
+        }
+        if (contadores.size() < capacidade_) {
+            std::uint32_t c = contadores.size();
+            contadores.push_back(Contador{std::string(palavra), 1, 0});
+            lugar.push_back(heap.size());
+            heap.push_back(c);
+            subir(heap.size() - 1);
+            indice.emplace(contadores[c].palavra, c);
+            return;
+        }
+        Contador& alvo = contadores[heap[0]];
+        auto no = indice.extract(alvo.palavra);
+        alvo.palavra.assign(palavra);
+        alvo.erro = alvo.contagem++;
+        no.key() = alvo.palavra;
+        indice.insert(std::move(no));
+        descer(0);
+    }
+
+    // Combina os resumos em até `capacidade` contadores, do mais ao menos frequente.
+    static std::vector<Contador> mesclar(const std::vector<ResumoEspacoEconomico>& resumos, size_t capacidade) {
+        struct Soma {
+            size_t contagem = 0, erro = 0, minimos = 0;
+        };
+        std::unordered_map<std::string_view, Soma> somas;
+        size_t total_minimos = 0;
+        for (const auto& r : resumos) {
+            size_t minimo = r.minimo();
+            total_minimos += minimo;
+            for (const auto& c : r.contadores) {
+                Soma& s = somas[c.palavra];
+                s.contagem += c.contagem;
+                s.erro += c.erro;
+                s.minimos += minimo;
+            }
+        }
+        std::vector<Contador> resultado;
+        resultado.reserve(somas.size());
+        for (const auto& [palavra, s] : somas) {
+            size_t ausente = total_minimos - s.minimos;
+            resultado.push_back(Contador{std::string(palavra), s.contagem + ausente, s.erro + ausente});
+        }
+        size_t n = std::min(capacidade, resultado.size());
+        std::partial_sort(resultado.begin(), resultado.begin() + n, resultado.end(), mais_frequente);
+        resultado.resize(n);
+        return resultado;
+    }
+};
+
+// As `k` entradas de maior contagem entre todas as fatias, da maior para a menor.
+inline std::vector<TabelaPalavras::Entrada> maiores_exatas(const std::vector<TabelaPalavras>& fatias, size_t k) {
+    auto mais_frequente = [](const TabelaPalavras::Entrada& a, const TabelaPalavras::Entrada& b) {
+        return a.contagem != b.contagem ? a.contagem > b.contagem : a.chave < b.chave;
+    };
+    std::vector<std::vector<TabelaPalavras::Entrada>> candidatos(fatias.size());
+    std::for_each(std::execution::par, fatias.begin(), fatias.end(), [&](const TabelaPalavras& fatia) {
+        auto& lista = candidatos[&fatia - &fatias[0]];
+        lista.reserve(fatia.tamanho());
+        fatia.para_cada([&](const TabelaPalavras::Entrada& e) { lista.push_back(e); });
+        size_t n = std::min(k, lista.size());
+        std::partial_sort(lista.begin(), lista.begin() + n, lista.end(), mais_frequente);
+        lista.resize(n);
+    });
+    std::vector<TabelaPalavras::Entrada> maiores;
+    for (const auto& lista : candidatos) maiores.insert(maiores.end(), lista.begin(), lista.end());
+    size_t n = std::min(k, maiores.size());
+    std::partial_sort(maiores.begin(), maiores.begin() + n, maiores.end(), mais_frequente);
+    maiores.resize(n);
+    return maiores;
+}
@@ -5,7 +5,7 @@ Este programa faz parte do material que acompanha o curso "Programação Multith
 
 Descrição do Programa
 
-Este programa, escrito em C++20, implementa uma versão concorrente do Jogo da Vida de Conway, com a divisão do grid global em blocos distribuídos entre várias threads. Cada bloco evolui independentemente, e as threads responsáveis por sua atualização operam de forma paralela. A troca de fronteiras entre blocos ainda não está implementada neste exemplo, o que limita a precisão da simulação ao longo do tempo, mas ilustra a estrutura geral de divisão de trabalho.
+Este programa, escrito em C++20, implementa uma versão concorrente do Jogo da Vida de Conway, com a divisão do grid global em blocos distribuídos entre várias threads. Cada bloco mantém uma moldura de células fantasmas (linhas e colunas extras ao seu redor) que, a cada geração, é preenchida com as bordas dos blocos vizinhos, recebidas por canais de fronteira dedicados. As threads permanecem vivas durante toda a simulação: inicializam o bloco, trocam fronteiras, calculam a geração e se sincronizam em uma barreira antes de passar à geração seguinte. Desta forma, o resultado paralelo é idêntico ao de uma execução sequencial sobre o grid global (as células fora do grid são consideradas mortas).
 
 Parâmetros de Lançamento
 
@@ -15,6 +15,30 @@ O programa recebe três argumentos obrigatórios:
 2. `divisoes`: número de divisões \( D \) em cada direção, totalizando \( D^2 \) blocos e threads.
 3. `iteracoes`: número de iterações (gerações) do Jogo da Vida.
 
+E as seguintes opções, após os argumentos obrigatórios:
+
+- `--modo=halo`: (padrão) blocos trocam fronteiras com os vizinhos a cada geração.
+- `--modo=isolado`: comportamento original, em que cada bloco evolui isoladamente, sem troca de fronteiras.
+- `--modo=tarefas`: (apenas `--motor=celulas`) desacopla o número de threads do número de blocos. O grid global é cortado em \( D^2 \) ladrilhos, e um conjunto fixo de threads os disputa a cada geração por um contador atômico; como todos leem o mesmo grid, não há troca de fronteiras.
+- `--threads=P`: número de threads do modo `tarefas` (padrão: `std::thread::hardware_concurrency()`).
+- `--largura=k`: (apenas `--modo=halo` com `--motor=celulas`) blocos com moldura de k células fantasmas, trocada a cada k gerações. Entre duas trocas, cada bloco recalcula de forma redundante a faixa da moldura que ainda é válida, trocando sincronização por trabalho extra; ao final, relata o número de trocas e a fração de células recalculadas.
+- `--regra=B3/S23`: regra "Life-like" na notação B/S (ou S/B, como `23/36`), por exemplo `B36/S23` (HighLife) ou `B3678/S34678` (Day & Night). As regras mais comuns têm núcleos especializados em tempo de compilação; as demais usam uma tabela genérica (`jogo_da_vida_regra.hpp`). Regras com B0 não são aceitas, pois as células fora do grid são sempre mortas, e `--motor=bits` implementa apenas B3/S23.
+- `--numa`: (modos e motores por blocos) lê do sysfs a topologia de CPUs, caches e nós NUMA (`jogo_da_vida_topologia.hpp`), fixa cada thread em uma CPU, de modo que blocos vizinhos fiquem em núcleos que compartilham a cache de último nível, e faz cada thread alocar o próprio bloco e os canais pelos quais recebe as bordas depois de fixada, para que essa memória fique no seu nó. Relata no início quantos blocos ficaram com memória local ou remota.
+- `--motor=celulas`: (padrão) cada célula ocupa um byte de um `Grid` contíguo com moldura de células fantasmas (`jogo_da_vida_grade.hpp`), percorrido em ladrilhos por `step`.
+- `--motor=bits`: cada bloco armazena 64 células por `uint64_t` e evolui palavras inteiras com um somador "bit-sliced" (e AVX2, quando disponível), conforme `jogo_da_vida_bits.hpp`. O resultado é idêntico ao do motor padrão.
+- `--motor=hashlife`: evolui o grid global com o algoritmo HashLife (`jogo_da_vida_hashlife.hpp`): uma quadtree de nós canônicos que memoriza o futuro de cada nó, adequada a padrões esparsos e a números muito grandes de gerações. Simula o plano ilimitado, do qual o grid N x N é a janela observada; `divisoes` define apenas a semeadura inicial.
+- `--motor=hashlife-par`: como `hashlife`, distribuindo entre threads as sub-árvores do nível mais alto.
+- `--memoria=MB`: orçamento de memória da tabela de nós do HashLife (padrão 1024). É o limiar que dispara a coleta de nós entre dois saltos, não um limite rígido: um salto pode ultrapassá-lo, e a memória reservada (informada ao final) não diminui depois de uma coleta, embora os nós liberados sejam reaproveitados.
+- `--ativos`: (apenas `--motor=celulas`) divide cada bloco em ladrilhos de 16x64 células e recalcula somente os ladrilhos que mudaram, ou cujos vizinhos (ou células fantasmas adjacentes) mudaram, na geração anterior. Relata a fração de ladrilhos ativos em cada geração.
+- `--padrao=arquivo`: em vez da semeadura aleatória, carrega um padrão em formato RLE (`.rle`) ou texto simples (`.cells`), centralizado no grid.
+- `--restaurar=arquivo`: retoma a simulação a partir de um checkpoint binário gravado por `--salvar`.
+- `--salvar=arquivo`: grava o estado final em um checkpoint binário (8 células por byte, escrito via `mmap`), junto com o número da geração.
+- `--quadros=arquivo:K`: (motores por blocos) grava, em uma thread dedicada, um quadro a cada K gerações com apenas as sequências de células alteradas desde o quadro anterior.
+- `--verificar`: compara o estado final com uma execução sequencial sobre o grid global (para o HashLife, cercado por uma margem de células mortas suficiente para emular o plano ilimitado).
+- `--silencioso`: não imprime os grids, apenas o tempo e a vazão (células por segundo).
+
+Modo lote: `./jogo_da_vida --lote=arquivo [--threads=P]` executa muitas simulações independentes, uma por linha do arquivo (`dimensao iteracoes semente [regra] [densidade]`), distribuídas entre P threads fixas (padrão: `std::thread::hardware_concurrency()`) que reaproveitam seus buffers entre simulações. Em vez dos grids, cada simulação concluída produz uma linha CSV com a população final e a geração a partir da qual o estado se repete com período 1 ou 2; ao estabilizar, a simulação é encerrada e o estado final é deduzido pela paridade. O tempo total e a vazão (simulações por segundo) saem na saída de erro. Com `--verificar`, cada simulação é repetida até a última geração, sem a parada antecipada, e os estados finais são comparados.
+
 Exemplo de uso:
 ./jogo_da_vida 40 4 10
 
@@ -22,186 +46,966 @@ Esse comando divide um grid de 40x40 em 16 blocos de 10x10, cada um processado p
 
 Recursos de Programação Concorrente Utilizados
 
-- **`std::thread`**: cada bloco do grid é manipulado por uma thread distinta.
-- **Sincronização por `std::mutex`**: utilizada para escrita simultânea nas estruturas de saída (como o grid global impresso).
-- **Estrutura `Mailbox` com `std::condition_variable`**: embora preparada para permitir troca de mensagens entre blocos (como fronteiras), ainda não está integrada ao cálculo da vizinhança.
-- **Funções `print_block` e `print_grid`**: permitem consolidar os resultados parciais de cada bloco no grid global de maneira segura.
-
-Esta implementação demonstra o uso básico de paralelismo em C++ com threads explícitas, organizadas de forma estruturada, com uma infraestrutura de comunicação entre blocos que pode ser estendida para suportar sincronização completa entre vizinhos. A ausência de troca de fronteiras significa que os blocos processam suas células com base apenas no seu conteúdo interno.
-
-Essa versão serve como ponto de partida para versões mais completas com interação entre blocos ou modelos com sobreposição de fronteiras.
+- **`std::thread`**: cada bloco do grid é manipulado por uma thread distinta, criada uma única vez para toda a simulação.
+- **Escalonador de ladrilhos**: no modo `tarefas`, as threads de um conjunto fixo retiram o próximo ladrilho com `fetch_add` em um `std::atomic<int>`, equilibrando a carga sem uma thread por bloco; a função de conclusão da barreira troca os buffers e reinicia o contador.
+- **Afinidade de threads**: com `--numa`, cada thread se fixa com `pthread_setaffinity_np` antes de criar o bloco e seus canais de entrada (alocação por "first touch") e consulta o nó de suas páginas com `move_pages`.
+- **Conjunto fixo de threads no modo lote**: as simulações são retiradas da lista com `fetch_add` em um `std::atomic<int>`, e cada resumo é impresso sob `std::mutex` assim que a simulação termina.
+- **`std::barrier`**: sincroniza as threads ao final de cada geração (ou de cada fase de k gerações, com `--largura`), garantindo que as mensagens de fronteira de uma geração não se misturem com as da geração seguinte. Sua função de conclusão (`GenerationEnd`), executada uma vez por fase, relata a atividade da geração somada pelos blocos em contadores `std::atomic`.
+- **Sincronização por `std::mutex`**: utilizada para escrita simultânea na saída padrão. Os blocos copiam seus resultados para regiões disjuntas do grid global sem trava.
+- **Escritor de quadros em segundo plano**: `FrameWriter` recebe os quadros por um par de buffers, protegido por `std::mutex` e `std::condition_variable`, e os codifica e grava enquanto os blocos seguem calculando.
+- **Canais SPSC sem travas** (`jogo_da_vida_canal.hpp`): para cada par (bloco, direção do vizinho) há uma fila circular de um produtor e um consumidor, com compartimentos pré-alocados e reutilizados a cada geração. Cada bloco escreve suas bordas (linhas, colunas e cantos) diretamente nos compartimentos dos até oito vizinhos e lê as bordas deles para preencher sua moldura de células fantasmas. A recepção gira brevemente e depois bloqueia com `std::atomic::wait`.
+- **`std::async` e tabela fatiada com um `std::mutex` por fatia**: no HashLife paralelo, as sub-árvores do nível mais alto são avançadas em tarefas concorrentes que compartilham a tabela de nós canônicos; os resultados memorizados são publicados com `std::atomic`.
+- **Núcleos especializados por regra**: `step_row` é um template sobre a regra; `with_rule` escolhe, uma vez por ladrilho, uma instância com tabela `constexpr` (sem custo por célula em relação à regra fixa) ou a tabela genérica.
+- **Motores de bloco intercambiáveis**: `worker` é um template sobre o tipo do bloco (`CellBlock` ou `BitBlock`), que oferece acesso às células (incluindo a moldura) e a evolução de uma geração.
+- **Funções `print_block` e `print_grid`**: permitem consolidar os resultados parciais de cada bloco no grid global e imprimi-lo linha a linha.
+
+Esta implementação demonstra o uso de paralelismo em C++ com threads explícitas, organizadas de forma estruturada, com troca de mensagens entre vizinhos e sincronização coletiva por barreira. O modo `isolado` é mantido para evidenciar, com `--verificar`, o erro cometido quando os blocos ignoram as fronteiras.
 */
 
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
-#include <queue>
+#include <barrier>
+#include <atomic>
 #include <random>
 #include <tuple>
 #include <memory>
 #include <cassert>
 #include <sstream>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "jogo_da_vida_bits.hpp"
+#include "jogo_da_vida_canal.hpp"
+#include "jogo_da_vida_grade.hpp"
+#include "jogo_da_vida_hashlife.hpp"
+#include "jogo_da_vida_io.hpp"
+#include "jogo_da_vida_regra.hpp"
+#include "jogo_da_vida_topologia.hpp"
+
+enum class Modo { Halo, Isolado, Tarefas };
+
+enum class Motor { Celulas, Bits, HashLife, HashLifePar };
+
+// Instantes de início e fim da evolução, registrados pela thread 0 entre barreiras.
+struct Timing {
+    std::chrono::steady_clock::time_point inicio, fim;
+};
 
-using Grid = std::vector<std::vector<int>>;
+// Custo das bordas largas: número de trocas de fronteira e células calculadas
+// dentro e fora do interior dos blocos.
+struct Overlap {
+    std::atomic<long> exchanges{0};
+    std::atomic<long long> useful{0}, redundant{0};
+};
 
-struct Message {
-    int from_id;
-    Grid border_data;
-    std::string direction; // "TOP", "BOTTOM", "LEFT", "RIGHT"
+// Modo --numa: CPU de cada bloco e onde a memória dos blocos foi parar.
+struct Placement {
+    std::vector<Topology::Cpu> cpus;  // indexado pelo id do bloco
+    int nodes = 1;
+    std::atomic<int> local{0}, remote{0}, unknown{0}, unpinned{0};
+
+    void report() const {
+        std::cout << "Topologia: " << cpus.size() << " blocos em " << nodes << " no(s) NUMA; memoria "
+                  << local << " local, " << remote << " remota";
+        if (unknown) std::cout << ", " << unknown << " desconhecida";
+        if (unpinned) std::cout << " (" << unpinned << " threads nao fixadas)";
+        std::cout << '\n';
+    }
 };
 
-class Mailbox {
-    std::mutex mtx;
-    std::condition_variable cv;
-    std::queue<Message> queue;
-public:
-    Mailbox() = default;
-    Mailbox(const Mailbox&) = delete;
-    Mailbox& operator=(const Mailbox&) = delete;
+// Ladrilhos ativos na geração corrente, somados por todos os blocos.
+struct Activity {
+    std::atomic<long> active{0}, total{0};
+};
 
-    void send(const Message& msg) {
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            queue.push(msg);
+// Gerações avançadas por uma fase a partir de `generation`: até `width`, sem
+// passar de `limit` nem de um múltiplo de `interval` (quadro pendente), para
+// que cada fase grave no máximo um quadro, ao seu final.
+int round_length(std::uint64_t generation, std::uint64_t limit, int width, int interval) {
+    if (width <= 1) return 1;
+    std::uint64_t g = std::min<std::uint64_t>(width, limit - generation);
+    if (interval > 0) g = std::min<std::uint64_t>(g, interval - generation % interval);
+    return static_cast<int>(g);
+}
+
+// Executada uma única vez ao fim de cada fase da barreira, depois que todas as
+// threads chegaram. A primeira fase encerra a inicialização (o estado inicial
+// vira o primeiro quadro); as demais encerram uma geração, cuja atividade é
+// relatada e zerada e cujo quadro, se houver, é entregue ao escritor.
+struct GenerationEnd {
+    Activity* activity;
+    FrameWriter* frames;        // nulo sem --quadros
+    const Grid* initial;
+    std::uint64_t generation;   // geração absoluta do estado corrente
+    std::function<void(std::uint64_t)> on_generation = nullptr;  // executado a cada geração
+    int width = 1;              // gerações por fase (--largura)
+    std::uint64_t limit = 0;    // última geração, usada quando width > 1
+    bool started = false;
+
+    void operator()() noexcept {
+        if (!started) {
+            started = true;
+            if (frames) {
+                for (int y = 0; y < initial->height(); ++y)
+                    std::memcpy(frames->buffer().row(y), initial->row(y), initial->width());
+                frames->submit(generation);
+            }
+            return;
         }
-        cv.notify_one();
+        generation += round_length(generation, limit, width, frames ? frames->interval() : 0);
+        long total = activity->total.exchange(0);
+        long active = activity->active.exchange(0);
+        if (total > 0)
+            std::cout << "Geracao " << generation << ": " << active << "/" << total
+                      << " ladrilhos ativos (" << 100.0 * active / total << "%)\n";
+        if (on_generation) on_generation(generation);
+        if (frames && generation % frames->interval() == 0)
+            frames->submit(generation);
     }
+};
+
+using Barrier = std::barrier<GenerationEnd>;
+
+struct Config {
+    int N = 0;
+    int D = 0;
+    int T = 0;
+    Modo modo = Modo::Halo;
+    int threads = 0;  // modo tarefas: 0 = hardware_concurrency()
+    int largura = 1;  // largura da moldura de células fantasmas (gerações por troca)
+    Rule regra;       // B3/S23, salvo --regra
+    bool numa = false;
+    bool ativos = false;
+    Motor motor = Motor::Celulas;
+    std::size_t memoria_mb = 1024;  // limiar de coleta da tabela de nós do HashLife
+    std::string padrao, restaurar, salvar, quadros;
+    int intervalo_quadros = 0;
+    std::uint64_t geracao_inicial = 0;  // lida do checkpoint restaurado
+    bool verificar = false;
+    bool silencioso = false;
+};
 
-    Message receive() {
-        std::unique_lock<std::mutex> lock(mtx);
-        cv.wait(lock, [&]{ return !queue.empty(); });
-        Message msg = queue.front();
-        queue.pop();
-        return msg;
+// Dimensões dos ladrilhos percorridos por `step`: três linhas de TILE_W bytes
+// cabem com folga na cache L1, e TILE_H linhas por ladrilho mantêm as linhas
+// reaproveitadas entre iterações de y na L2.
+constexpr int TILE_H = 64;
+constexpr int TILE_W = 4096;
+
+// Ladrilhos usados no rastreamento de atividade (`--ativos`): pequenos o
+// bastante para isolar regiões estáveis, com uma linha de cache de largura.
+constexpr int ACTIVE_TILE_H = 16;
+constexpr int ACTIVE_TILE_W = 64;
+
+// Evolui as células [x0, x1) de uma linha, dadas as linhas acima e abaixo, e
+// devolve um valor não nulo se alguma célula mudou de estado. `R` é uma regra
+// de `jogo_da_vida_regra.hpp`.
+// Os ponteiros `__restrict` dispensam testes de sobreposição em tempo de
+// execução; o laço é vetorizado com o modelo de custo definido no Makefile,
+// e o acúmulo em `diff` vira um OU de vetores, reduzido só ao fim da linha.
+template <typename R>
+inline std::uint8_t step_row(const R& rule,
+                     const std::uint8_t* __restrict up, const std::uint8_t* __restrict mid,
+                     const std::uint8_t* __restrict down, std::uint8_t* __restrict out,
+                     int x0, int x1) {
+    std::uint8_t diff = 0;
+    for (int x = x0; x < x1; ++x) {
+        std::uint8_t n = up[x-1] + up[x] + up[x+1]
+                       + mid[x-1]        + mid[x+1]
+                       + down[x-1] + down[x] + down[x+1];
+        out[x] = rule.apply(n, mid[x]);
+        diff |= out[x] ^ mid[x];
     }
+    return diff;
+}
+
+// Evolui o retângulo [y0, y1) x [x0, x1) do interior de `current`. A moldura
+// de células fantasmas garante que os acessos a y-1, y+1, x-1 e x+1 são válidos.
+// Devolve verdadeiro se alguma célula do retângulo mudou de estado.
+// A variante da regra é escolhida aqui, uma vez por ladrilho.
+bool step_tile(const Rule& rule, const Grid& current, Grid& next, int y0, int y1, int x0, int x1) {
+    return with_rule(rule, [&](const auto& r) {
+        std::uint8_t diff = 0;
+        for (int y = y0; y < y1; ++y)
+            diff |= step_row(r, current.row(y - 1), current.row(y), current.row(y + 1), next.row(y), x0, x1);
+        return diff != 0;
+    });
+}
 
-    bool try_receive(Message& msg) {
-        std::lock_guard<std::mutex> lock(mtx);
-        if (queue.empty()) return false;
-        msg = queue.front();
-        queue.pop();
-        return true;
+// Evolui o retângulo [y0, y1) x [x0, x1), que pode avançar sobre a moldura,
+// percorrido em ladrilhos. Devolve verdadeiro se alguma célula mudou.
+bool step_region(const Rule& rule, const Grid& current, Grid& next, int y0, int y1, int x0, int x1) {
+    bool changed = false;
+    for (int ty = y0; ty < y1; ty += TILE_H)
+        for (int tx = x0; tx < x1; tx += TILE_W)
+            changed |= step_tile(rule, current, next, ty, std::min(ty + TILE_H, y1), tx, std::min(tx + TILE_W, x1));
+    return changed;
+}
+
+// Evolui todo o interior de `current`. As células da moldura contam como
+// vizinhas (mortas, se nunca forem preenchidas).
+bool step(const Rule& rule, const Grid& current, Grid& next) {
+    return step_region(rule, current, next, 0, current.height(), 0, current.width());
+}
+
+// Motor padrão: um byte por célula, em um Grid com moldura de células fantasmas.
+//
+// Com `step_active`, o bloco é dividido em ladrilhos com um bit de mudança
+// cada. Um ladrilho só é recalculado se ele ou algum ladrilho vizinho mudou na
+// geração anterior, ou se uma célula fantasma adjacente recebeu um valor novo.
+// Um ladrilho que não mudou tem o mesmo conteúdo nos dois buffers, portanto
+// pode ser pulado sem cópia.
+//
+// Com uma moldura de largura k > 1 (`--largura`), `step_extended` calcula
+// também parte da moldura, de modo que k gerações avançam com uma única troca
+// de fronteiras: a cada geração a faixa válida da moldura encolhe uma célula.
+class CellBlock {
+    Rule rule;
+    Grid current, next;
+    int tiles_y, tiles_x;
+    std::vector<std::uint8_t> changed, wake, scratch;
+
+    void wake_tile(int y, int x) {
+        y = std::clamp(y, 0, size() - 1);
+        x = std::clamp(x, 0, size() - 1);
+        wake[(y / ACTIVE_TILE_H) * tiles_x + x / ACTIVE_TILE_W] = 1;
     }
-};
 
-int count_neighbors(const Grid& grid, int y, int x) {
-    static const int dy[] = {-1,-1,-1, 0,0, 1,1,1};
-    static const int dx[] = {-1, 0, 1,-1,1,-1,0,1};
-    int count = 0;
-    int H = grid.size();
-    int W = grid[0].size();
-    for (int d = 0; d < 8; ++d) {
-        int ny = y + dy[d];
-        int nx = x + dx[d];
-        if (ny >= 0 && ny < H && nx >= 0 && nx < W)
-            count += grid[ny][nx];
+public:
+    explicit CellBlock(int block_size, int border = 1, Rule rule = {})
+        : rule(rule), current(block_size, block_size, border), next(block_size, block_size, border),
+          tiles_y((block_size + ACTIVE_TILE_H - 1) / ACTIVE_TILE_H),
+          tiles_x((block_size + ACTIVE_TILE_W - 1) / ACTIVE_TILE_W),
+          changed(tiles_y * tiles_x, 1), wake(changed.size(), 1), scratch(changed.size()) {}
+
+    // Coordenadas na moldura: o interior vai de 1 a bs; 0 e bs+1 (e, com uma
+    // moldura larga, as coordenadas além delas) são células fantasmas.
+    int size() const { return current.height(); }
+    int border() const { return current.border(); }
+    const void* data() const { return current.row(0); }
+    std::size_t bytes() const { return static_cast<std::size_t>(current.height()) * current.stride(); }
+    int get(int y, int x) const { return current(y - 1, x - 1); }
+
+    // Uma célula fantasma que difere da recebida na geração anterior (guardada
+    // no outro buffer) acorda o ladrilho vizinho.
+    void set(int y, int x, int v) {
+        bool ghost = y < 1 || x < 1 || y > size() || x > size();
+        if (ghost && next(y - 1, x - 1) != v) wake_tile(y - 1, x - 1);
+        current(y - 1, x - 1) = v;
+    }
+
+    int tile_count() const { return tiles_y * tiles_x; }
+
+    // Copia a linha `y` do interior (0 a bs-1) para `out`.
+    void read_row(int y, std::uint8_t* out) const {
+        std::memcpy(out, current.row(y), size());
     }
-    return count;
-}
 
-void step(Grid& current, Grid& next) {
-    int H = current.size();
-    int W = current[0].size();
-    for (int y = 0; y < H; ++y) {
-        for (int x = 0; x < W; ++x) {
-            int n = count_neighbors(current, y, x);
-            if (current[y][x] == 1)
-                next[y][x] = (n == 2 || n == 3) ? 1 : 0;
-            else
-                next[y][x] = (n == 3) ? 1 : 0;
+    void step() {
+        ::step(rule, current, next);
+        std::swap(current, next);
+    }
+
+    // Evolui o interior acrescido de `top`, `bottom`, `left` e `right` células
+    // da moldura; devolve o número de células calculadas.
+    long step_extended(int top, int bottom, int left, int right) {
+        int bs = size();
+        step_region(rule, current, next, -top, bs + bottom, -left, bs + right);
+        std::swap(current, next);
+        return static_cast<long>(bs + top + bottom) * (bs + left + right);
+    }
+
+    // Evolui apenas os ladrilhos ativos e devolve quantos foram calculados.
+    int step_active() {
+        int bs = size(), active = 0;
+        for (int ty = 0; ty < tiles_y; ++ty) {
+            for (int tx = 0; tx < tiles_x; ++tx) {
+                bool act = wake[ty * tiles_x + tx];
+                for (int ny = std::max(ty - 1, 0); !act && ny <= std::min(ty + 1, tiles_y - 1); ++ny)
+                    for (int nx = std::max(tx - 1, 0); nx <= std::min(tx + 1, tiles_x - 1); ++nx)
+                        act |= changed[ny * tiles_x + nx] != 0;
+                scratch[ty * tiles_x + tx] = act && step_tile(rule, current, next,
+                    ty * ACTIVE_TILE_H, std::min((ty + 1) * ACTIVE_TILE_H, bs),
+                    tx * ACTIVE_TILE_W, std::min((tx + 1) * ACTIVE_TILE_W, bs));
+                active += act;
+            }
         }
+        changed.swap(scratch);
+        std::fill(wake.begin(), wake.end(), 0);
+        std::swap(current, next);
+        return active;
     }
-}
+};
 
 std::mutex print_mtx;
 
-void print_block(const Grid& grid, int offset_y, int offset_x, Grid& global) {
-    std::lock_guard<std::mutex> lock(print_mtx);
-    for (size_t y = 0; y < grid.size(); ++y)
-        for (size_t x = 0; x < grid[y].size(); ++x)
-            global[offset_y + y][offset_x + x] = grid[y][x];
+// Copia o interior do bloco (sem a moldura) para o grid global. Cada bloco
+// escreve um retângulo disjunto do buffer contíguo, sem necessidade de trava.
+template <typename Block>
+void print_block(const Block& block, int offset_y, int offset_x, Grid& global) {
+    for (int y = 0; y < block.size(); ++y)
+        block.read_row(y, global.row(offset_y + y) + offset_x);
+}
+
+// Caminho inverso: preenche o bloco a partir do grid global.
+template <typename Block>
+void load_block(Block& block, int offset_y, int offset_x, const Grid& global) {
+    for (int y = 1; y <= block.size(); ++y)
+        for (int x = 1; x <= block.size(); ++x)
+            block.set(y, x, global(offset_y + y - 1, offset_x + x - 1));
 }
 
+// Imprime o grid linha a linha, montando cada linha em um buffer.
 void print_grid(const Grid& grid) {
-    for (const auto& row : grid) {
-        for (int val : row)
-            std::cout << (val ? 'O' : '.');
-        std::cout << '\n';
+    std::string line(grid.width() + 1, '\n');
+    for (int y = 0; y < grid.height(); ++y) {
+        const std::uint8_t* row = grid.row(y);
+        for (int x = 0; x < grid.width(); ++x)
+            line[x] = row[x] ? 'O' : '.';
+        std::cout.write(line.data(), line.size());
     }
 }
 
-void worker(int id, int row_blocks, int col_blocks, int block_y, int block_x,
-            int block_size, int iterations,
-            std::vector<std::vector<std::shared_ptr<Mailbox>>>& mailboxes,
-            Grid& global_grid) {
-    Grid local(block_size, std::vector<int>(block_size));
-    Grid next(block_size, std::vector<int>(block_size));
+// Vizinhos de um bloco: deslocamento (dy, dx) e a posição do vizinho vista
+// por este bloco, que indexa o canal de fronteira pelo qual a borda chega.
+struct Neighbor {
+    int dy, dx;
+    Direction direction;
+};
+
+static const Neighbor neighbors[] = {
+    {-1, -1, Direction::TopLeft},    {-1, 0, Direction::Top},    {-1, 1, Direction::TopRight},
+    { 0, -1, Direction::Left},                                   { 0, 1, Direction::Right},
+    { 1, -1, Direction::BottomLeft}, { 1, 0, Direction::Bottom}, { 1, 1, Direction::BottomRight},
+};
+
+// Uma borda: linha, coluna ou canto, um byte por célula.
+using Border = std::vector<std::uint8_t>;
+using BorderChannel = SpscChannel<Border>;
+
+// Extrai para `out` a borda do bloco que interessa ao vizinho em (dy, dx):
+// `k` linhas, `k` colunas ou um canto k x k do interior.
+template <typename Block>
+void extract_border(const Block& local, int dy, int dx, Border& out, int k = 1) {
+    int bs = local.size();
+    int y0 = dy > 0 ? bs - k + 1 : 1, y1 = dy < 0 ? k : bs;
+    int x0 = dx > 0 ? bs - k + 1 : 1, x1 = dx < 0 ? k : bs;
+    std::size_t i = 0;
+    for (int y = y0; y <= y1; ++y)
+        for (int x = x0; x <= x1; ++x)
+            out[i++] = local.get(y, x);
+}
+
+// Copia a borda recebida do vizinho em (dy, dx) para o lado correspondente
+// da moldura de células fantasmas.
+template <typename Block>
+void fill_ghosts(Block& local, int dy, int dx, const Border& in, int k = 1) {
+    int bs = local.size();
+    int y0 = dy < 0 ? 1 - k : (dy > 0 ? bs + 1 : 1), y1 = dy < 0 ? 0 : (dy > 0 ? bs + k : bs);
+    int x0 = dx < 0 ? 1 - k : (dx > 0 ? bs + 1 : 1), x1 = dx < 0 ? 0 : (dx > 0 ? bs + k : bs);
+    std::size_t i = 0;
+    for (int y = y0; y <= y1; ++y)
+        for (int x = x0; x <= x1; ++x)
+            local.set(y, x, in[i++]);
+}
 
+// Canais de fronteira: `channels[id * 8 + d]` recebe, no bloco `id`, a borda
+// do vizinho na direção `d` (nulo se o vizinho não existe). Cada bloco cria os
+// próprios canais de entrada, de modo que, com --numa, eles também ficam no nó
+// da sua thread.
+using Channels = std::vector<std::unique_ptr<BorderChannel>>;
+
+// Estado inicial de um bloco: células aleatórias com semente igual ao id do bloco.
+template <typename Block>
+void seed_block(Block& block, int id) {
     std::mt19937 gen(id);
     std::uniform_int_distribution<> dist(0, 1);
-    for (auto& row : local)
-        for (auto& cell : row)
-            cell = dist(gen);
+    for (int y = 1; y <= block.size(); ++y)
+        for (int x = 1; x <= block.size(); ++x)
+            block.set(y, x, dist(gen));
+}
 
-    print_block(local, block_y * block_size, block_x * block_size, global_grid);
+template <typename Block>
+void worker(int id, int row_blocks, int col_blocks, int block_y, int block_x,
+            int block_size, const Config& cfg,
+            Channels& channels,
+            Barrier& sync, Activity& activity, Overlap& overlap, Placement* placement,
+            Timing& timing, FrameWriter* frames, Grid& grid_inicio, Grid& grid_fim) {
+    // Fixada antes de criar o bloco, a thread é a primeira a escrever nele, e
+    // o núcleo aloca suas páginas no nó da CPU escolhida.
+    if (placement && !pin_current_thread(placement->cpus[id].id)) ++placement->unpinned;
+    int k = cfg.largura;
+    Block local = [&] {
+        if constexpr (requires { Block(block_size, k, cfg.regra); }) return Block(block_size, k, cfg.regra);
+        else return Block(block_size);
+    }();
+    if (cfg.padrao.empty() && cfg.restaurar.empty()) {
+        seed_block(local, id);
+        print_block(local, block_y * block_size, block_x * block_size, grid_inicio);
+    } else {
+        load_block(local, block_y * block_size, block_x * block_size, grid_inicio);
+    }
 
-    for (int t = 0; t < iterations; ++t) {
-        step(local, next);
-        std::swap(local, next);
+    // Compartimentos pré-alocados: k linhas ou colunas do lado do bloco, um
+    // quadrado k x k para os cantos. Só são usados depois da barreira abaixo.
+    for (const auto& nb : neighbors) {
+        int ny = block_y + nb.dy, nx = block_x + nb.dx;
+        if (ny < 0 || ny >= row_blocks || nx < 0 || nx >= col_blocks) continue;
+        Border proto(nb.dy && nb.dx ? k * k : k * block_size);
+        channels[id * 8 + static_cast<int>(nb.direction)] = std::make_unique<BorderChannel>(proto);
     }
 
-    print_block(local, block_y * block_size, block_x * block_size, global_grid);
-    std::lock_guard<std::mutex> lock(print_mtx);
-    std::cout << "Thread [" << block_y << "," << block_x << "] finalizou\n";
-}
+    if (placement) {
+        int node = page_node(local.data(), local.bytes());
+        ++(node < 0 ? placement->unknown : node == placement->cpus[id].node ? placement->local : placement->remote);
+    }
 
-int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        std::cerr << "Uso: " << argv[0] << " <dimensao> <divisoes> <iteracoes>\n";
-        return 1;
+    sync.arrive_and_wait();
+    if (id == 0 && placement) placement->report();
+    if (id == 0) timing.inicio = std::chrono::steady_clock::now();
+
+    // Cada fase avança `g` gerações (1, exceto com --largura) entre duas trocas.
+    std::uint64_t generation = cfg.geracao_inicial, limit = cfg.geracao_inicial + cfg.T;
+    int interval = frames ? frames->interval() : 0;
+    long exchanges = 0;
+    long long useful = 0, redundant = 0;
+    while (generation < limit) {
+        int g = round_length(generation, limit, k, interval);
+        if (cfg.modo == Modo::Halo) {
+            ++exchanges;
+            // O vizinho em (dy, dx) me vê na direção oposta.
+            for (const auto& nb : neighbors) {
+                int ny = block_y + nb.dy, nx = block_x + nb.dx;
+                if (ny < 0 || ny >= row_blocks || nx < 0 || nx >= col_blocks)
+                    continue;
+                int nid = ny * col_blocks + nx;
+                BorderChannel& ch = *channels[nid * 8 + static_cast<int>(opposite(nb.direction))];
+                extract_border(local, nb.dy, nb.dx, ch.acquire(), k);
+                ch.publish();
+            }
+            for (const auto& nb : neighbors) {
+                if (BorderChannel* ch = channels[id * 8 + static_cast<int>(nb.direction)].get()) {
+                    fill_ghosts(local, nb.dy, nb.dx, ch->receive(), k);
+                    ch->release();
+                }
+            }
+        }
+        bool stepped = false;
+        if constexpr (requires { local.step_extended(0, 0, 0, 0); }) {
+            if (k > 1) {
+                // Na geração i da fase, a moldura ainda é válida até g-1-i
+                // células do interior; nas bordas do grid global não há
+                // moldura a calcular (as células de fora são mortas).
+                long interior = static_cast<long>(block_size) * block_size;
+                for (int i = 0; i < g; ++i) {
+                    int e = g - 1 - i;
+                    long cells = local.step_extended(block_y > 0 ? e : 0, block_y < row_blocks - 1 ? e : 0,
+                                                     block_x > 0 ? e : 0, block_x < col_blocks - 1 ? e : 0);
+                    useful += interior;
+                    redundant += cells - interior;
+                }
+                stepped = true;
+            }
+        }
+        if constexpr (requires { local.step_active(); }) {
+            if (cfg.ativos) {
+                activity.active += local.step_active();
+                activity.total += local.tile_count();
+                stepped = true;
+            }
+        }
+        if (!stepped) local.step();
+        generation += g;
+        if (frames && generation % interval == 0)
+            print_block(local, block_y * block_size, block_x * block_size, frames->buffer());
+        // Nenhum bloco envia as bordas da fase seguinte antes que todos tenham
+        // consumido as desta.
+        sync.arrive_and_wait();
     }
 
-    int N = std::stoi(argv[1]);
-    int D = std::stoi(argv[2]);
-    int T = std::stoi(argv[3]);
+    if (id == 0) {
+        timing.fim = std::chrono::steady_clock::now();
+        overlap.exchanges = exchanges;
+    }
+    overlap.useful += useful;
+    overlap.redundant += redundant;
 
-    assert(N % D == 0);
-    int block_size = N / D;
+    print_block(local, block_y * block_size, block_x * block_size, grid_fim);
+    if (!cfg.silencioso) {
+        std::lock_guard<std::mutex> lock(print_mtx);
+        std::cout << "Thread [" << block_y << "," << block_x << "] finalizou\n";
+    }
+}
 
-    std::vector<std::vector<std::shared_ptr<Mailbox>>> mailboxes(D);
-    for (int i = 0; i < D; ++i)
-        for (int j = 0; j < D; ++j)
-            mailboxes[i].push_back(std::make_shared<Mailbox>());
+bool parse_args(int argc, char* argv[], Config& cfg) {
+    if (argc < 4) return false;
+    cfg.N = std::stoi(argv[1]);
+    cfg.D = std::stoi(argv[2]);
+    cfg.T = std::stoi(argv[3]);
+    for (int i = 4; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (opt == "--modo=halo") cfg.modo = Modo::Halo;
+        else if (opt == "--modo=isolado") cfg.modo = Modo::Isolado;
+        else if (opt == "--modo=tarefas") cfg.modo = Modo::Tarefas;
+        else if (opt.starts_with("--threads=")) cfg.threads = std::stoi(opt.substr(10));
+        else if (opt.starts_with("--largura=")) cfg.largura = std::stoi(opt.substr(10));
+        else if (opt == "--numa") cfg.numa = true;
+        else if (opt.starts_with("--regra=")) {
+            auto regra = parse_rule(opt.substr(8));
+            if (!regra || (regra->birth & 1)) {
+                std::cerr << "Regra invalida: " << opt.substr(8) << " (use a notacao B/S, sem B0)\n";
+                return false;
+            }
+            cfg.regra = *regra;
+        }
+        else if (opt == "--motor=celulas") cfg.motor = Motor::Celulas;
+        else if (opt == "--motor=bits") cfg.motor = Motor::Bits;
+        else if (opt == "--motor=hashlife") cfg.motor = Motor::HashLife;
+        else if (opt == "--motor=hashlife-par") cfg.motor = Motor::HashLifePar;
+        else if (opt.starts_with("--memoria=")) cfg.memoria_mb = std::stoul(opt.substr(10));
+        else if (opt == "--ativos") cfg.ativos = true;
+        else if (opt.starts_with("--padrao=")) cfg.padrao = opt.substr(9);
+        else if (opt.starts_with("--restaurar=")) cfg.restaurar = opt.substr(12);
+        else if (opt.starts_with("--salvar=")) cfg.salvar = opt.substr(9);
+        else if (opt.starts_with("--quadros=") && opt.find(':') != std::string::npos) {
+            cfg.quadros = opt.substr(10, opt.rfind(':') - 10);
+            cfg.intervalo_quadros = std::stoi(opt.substr(opt.rfind(':') + 1));
+        }
+        else if (opt == "--verificar") cfg.verificar = true;
+        else if (opt == "--silencioso") cfg.silencioso = true;
+        else {
+            std::cerr << "Opcao desconhecida: " << opt << '\n';
+            return false;
+        }
+    }
+    if (cfg.ativos && (cfg.motor != Motor::Celulas || cfg.modo == Modo::Tarefas)) {
+        std::cerr << "--ativos requer --motor=celulas e um modo por blocos\n";
+        return false;
+    }
+    if (cfg.modo == Modo::Tarefas && cfg.motor != Motor::Celulas) {
+        std::cerr << "--modo=tarefas requer --motor=celulas\n";
+        return false;
+    }
+    if (cfg.largura != 1 && (cfg.largura < 1 || cfg.modo != Modo::Halo || cfg.motor != Motor::Celulas
+                             || cfg.ativos || cfg.largura > cfg.N / std::max(cfg.D, 1))) {
+        std::cerr << "--largura=k requer --modo=halo, --motor=celulas sem --ativos e 1 <= k <= N/D\n";
+        return false;
+    }
+    if (cfg.motor == Motor::Bits && cfg.regra != Rule{}) {
+        std::cerr << "--motor=bits implementa apenas a regra B3/S23\n";
+        return false;
+    }
+    bool hashlife = cfg.motor == Motor::HashLife || cfg.motor == Motor::HashLifePar;
+    if (cfg.numa && (cfg.modo == Modo::Tarefas || hashlife)) {
+        std::cerr << "--numa requer um modo e um motor por blocos\n";
+        return false;
+    }
+    if (!cfg.quadros.empty() && (hashlife || cfg.intervalo_quadros <= 0)) {
+        std::cerr << "--quadros=arquivo:K requer K > 0 e um motor por blocos\n";
+        return false;
+    }
+    if (!cfg.padrao.empty() && !cfg.restaurar.empty()) {
+        std::cerr << "--padrao e --restaurar sao mutuamente exclusivos\n";
+        return false;
+    }
+    return cfg.N > 0 && cfg.D > 0 && cfg.T >= 0;
+}
 
-    Grid grid_inicio(N, std::vector<int>(N));
-    Grid grid_fim(N, std::vector<int>(N));
+// Motores por blocos: uma thread por bloco, durante toda a simulação.
+bool run_blocks(const Config& cfg, Grid& grid_inicio, Grid& grid_fim, Timing& timing) {
+    int D = cfg.D;
+    int block_size = cfg.N / D;
+
+    int k = cfg.largura;
+    Channels channels(D * D * 8);
+
+    std::unique_ptr<FrameWriter> frames;
+    if (!cfg.quadros.empty())
+        frames = FrameWriter::open(cfg.quadros, cfg.N, cfg.N, cfg.intervalo_quadros);
+    if (!cfg.quadros.empty() && !frames)
+        return false;
+
+    Activity activity;
+    Overlap overlap;
+    std::unique_ptr<Placement> placement;
+    if (cfg.numa) {
+        Topology topo = Topology::detect();
+        placement = std::make_unique<Placement>();
+        placement->cpus = topo.assign(D, D);
+        placement->nodes = topo.nodes;
+        if (placement->cpus.empty()) {
+            std::cerr << "--numa: nenhuma CPU utilizavel encontrada; threads nao serao fixadas\n";
+            placement.reset();
+        }
+    }
+    GenerationEnd end{&activity, frames.get(), &grid_inicio, cfg.geracao_inicial};
+    end.width = k;
+    end.limit = cfg.geracao_inicial + cfg.T;
+    Barrier sync(D * D, std::move(end));
 
     std::vector<std::thread> threads;
     for (int by = 0; by < D; ++by) {
         for (int bx = 0; bx < D; ++bx) {
             int id = by * D + bx;
-            threads.emplace_back(worker, id, D, D, by, bx, block_size, 0, std::ref(mailboxes), std::ref(grid_inicio));
+            auto fn = cfg.motor == Motor::Bits ? worker<BitBlock> : worker<CellBlock>;
+            threads.emplace_back(fn, id, D, D, by, bx, block_size, std::cref(cfg),
+                                 std::ref(channels), std::ref(sync), std::ref(activity), std::ref(overlap), placement.get(), std::ref(timing),
+                                 frames.get(), std::ref(grid_inicio), std::ref(grid_fim));
         }
     }
     for (auto& t : threads) t.join();
 
-    std::cout << "Estado inicial:\n";
-    print_grid(grid_inicio);
+    if (k > 1) {
+        long long useful = overlap.useful, redundant = overlap.redundant;
+        std::cout << "Moldura de largura " << k << ": " << overlap.exchanges << " trocas de fronteira (contra "
+                  << cfg.T << " com largura 1), " << redundant << " celulas recalculadas ("
+                  << (useful ? 100.0 * redundant / useful : 0.0) << "% de trabalho redundante)\n";
+    }
+    return true;
+}
 
-    threads.clear();
-    for (int by = 0; by < D; ++by) {
-        for (int bx = 0; bx < D; ++bx) {
-            int id = by * D + bx;
-            threads.emplace_back(worker, id, D, D, by, bx, block_size, T, std::ref(mailboxes), std::ref(grid_fim));
+// Modo tarefas: `divisoes` define apenas a granularidade, cortando o grid em
+// D x D ladrilhos. Um conjunto fixo de threads disputa os ladrilhos de cada
+// geração por um contador atômico, de modo que ladrilhos de custo desigual se
+// equilibram. Como todos leem o mesmo grid global, não há troca de bordas.
+bool run_tiles(const Config& cfg, Grid& grid_inicio, Grid& grid_fim, Timing& timing) {
+    int D = cfg.D;
+    int tile = cfg.N / D;
+    int tiles = D * D;
+    int P = cfg.threads > 0 ? cfg.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    Grid buffers[2] = {Grid(cfg.N, cfg.N), Grid(cfg.N, cfg.N)};
+    Grid* current = &buffers[0];
+    Grid* next = &buffers[1];
+    std::atomic<int> cursor{0};
+
+    std::unique_ptr<FrameWriter> frames;
+    if (!cfg.quadros.empty())
+        frames = FrameWriter::open(cfg.quadros, cfg.N, cfg.N, cfg.intervalo_quadros);
+    if (!cfg.quadros.empty() && !frames)
+        return false;
+
+    Activity activity;
+    GenerationEnd end{&activity, frames.get(), &grid_inicio, cfg.geracao_inicial};
+    end.on_generation = [&](std::uint64_t generation) {
+        std::swap(current, next);
+        cursor.store(0, std::memory_order_relaxed);
+        if (frames && generation % frames->interval() == 0)
+            for (int y = 0; y < cfg.N; ++y)
+                std::memcpy(frames->buffer().row(y), current->row(y), cfg.N);
+    };
+    Barrier sync(P, std::move(end));
+
+    bool seed = cfg.padrao.empty() && cfg.restaurar.empty();
+    auto pool_worker = [&](int w) {
+        // Inicialização também distribuída: cada ladrilho é semeado como o
+        // bloco de mesmo id nos modos por blocos.
+        CellBlock block(tile);
+        for (int i = w; i < tiles; i += P) {
+            int oy = i / D * tile, ox = i % D * tile;
+            if (seed) {
+                seed_block(block, i);
+                print_block(block, oy, ox, grid_inicio);
+            }
+            for (int y = 0; y < tile; ++y)
+                std::memcpy(current->row(oy + y) + ox, grid_inicio.row(oy + y) + ox, tile);
         }
-    }
+        sync.arrive_and_wait();
+        if (w == 0) timing.inicio = std::chrono::steady_clock::now();
+
+        for (int t = 0; t < cfg.T; ++t) {
+            for (int i; (i = cursor.fetch_add(1, std::memory_order_relaxed)) < tiles; ) {
+                int oy = i / D * tile, ox = i % D * tile;
+                step_tile(cfg.regra, *current, *next, oy, oy + tile, ox, ox + tile);
+            }
+            sync.arrive_and_wait();
+        }
+        if (w == 0) timing.fim = std::chrono::steady_clock::now();
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < P; ++w) threads.emplace_back(pool_worker, w);
     for (auto& t : threads) t.join();
 
-    std::cout << "Estado final apos " << T << " iteracoes:\n";
-    print_grid(grid_fim);
+    std::swap(grid_fim, *current);
+    std::cout << "Modo tarefas: " << tiles << " ladrilhos de " << tile << "x" << tile
+              << " em " << P << " threads\n";
+    return true;
+}
+
+// Motor HashLife: o estado inicial é o mesmo dos motores por blocos, mas a
+// evolução acontece sobre a quadtree do plano ilimitado.
+void run_hashlife(const Config& cfg, Grid& grid_inicio, Grid& grid_fim, Timing& timing) {
+    int block_size = cfg.N / cfg.D;
+    CellBlock block(block_size);
+    for (int by = 0; by < cfg.D && cfg.padrao.empty() && cfg.restaurar.empty(); ++by) {
+        for (int bx = 0; bx < cfg.D; ++bx) {
+            seed_block(block, by * cfg.D + bx);
+            print_block(block, by * block_size, bx * block_size, grid_inicio);
+        }
+    }
+
+    timing.inicio = std::chrono::steady_clock::now();
+    HashLife life(grid_inicio, cfg.memoria_mb << 20, cfg.motor == Motor::HashLifePar, cfg.regra);
+    life.advance(cfg.T);
+    timing.fim = std::chrono::steady_clock::now();
+
+    life.extract(grid_fim);
+    std::cout << "HashLife: populacao " << life.population() << ", " << life.nodes() << " nos ("
+              << (life.memory() >> 20) << " MB em uso, " << (life.reserved() >> 20) << " MB reservados), "
+              << life.collections() << " coletas\n";
+}
+
+// Modo lote: simulações independentes, descritas uma por linha em um arquivo:
+//
+//     dimensao iteracoes semente [regra] [densidade]
+//
+// Linhas vazias e iniciadas por `#` são ignoradas.
+struct Job {
+    int index = 0;
+    int N = 0, T = 0;
+    std::uint32_t seed = 0;
+    std::string regra = "B3/S23";
+    Rule rule;
+    double density = 0.5;
+};
+
+bool read_jobs(const std::string& path, std::vector<Job>& jobs) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Erro ao abrir a lista de simulacoes " << path << '\n';
+        return false;
+    }
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        if (line.empty() || line.starts_with("#")) continue;
+        std::istringstream fields(line);
+        Job job;
+        if (!(fields >> job.N >> job.T >> job.seed)) {
+            std::cerr << path << ":" << number << ": esperado 'dimensao iteracoes semente [regra] [densidade]'\n";
+            return false;
+        }
+        fields >> job.regra >> job.density;
+        auto rule = parse_rule(job.regra);
+        if (job.N <= 0 || job.T < 0 || !rule || (rule->birth & 1) || job.density < 0 || job.density > 1) {
+            std::cerr << path << ":" << number << ": simulacao invalida\n";
+            return false;
+        }
+        job.rule = *rule;
+        job.index = static_cast<int>(jobs.size());
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+// Resultado de uma simulação: população final e a primeira geração a partir
+// da qual o estado se repete com período 1 ou 2 (-1 se não estabilizou).
+struct JobResult {
+    long population = 0;
+    long stable_at = -1;
+    int period = 0;
+    const Grid* state = nullptr;  // estado final, dentro dos buffers da thread
+};
+
+// Buffers de uma thread do lote, reaproveitados entre simulações de mesma
+// dimensão. Três gerações ficam em memória para detectar o período 2.
+struct JobBuffers {
+    Grid grids[3];
+
+    void fit(int N) {
+        if (grids[0].height() == N) return;
+        for (auto& g : grids) g = Grid(N, N);
+    }
+};
+
+// Com `until_end`, avança todas as gerações, sem parar ao estabilizar (usado
+// por `--verificar`).
+JobResult run_job(const Job& job, JobBuffers& buffers, bool until_end = false) {
+    buffers.fit(job.N);
+    Grid* prev = &buffers.grids[0];
+    Grid* current = &buffers.grids[1];
+    Grid* next = &buffers.grids[2];
+
+    std::mt19937 gen(job.seed);
+    std::bernoulli_distribution alive(job.density);
+    for (int y = 0; y < job.N; ++y) {
+        std::uint8_t* row = current->row(y);
+        for (int x = 0; x < job.N; ++x) row[x] = alive(gen);
+    }
 
+    // Ao estabilizar, as gerações restantes só alternam entre estados já
+    // conhecidos: a simulação para e escolhe o estado final pela paridade.
+    JobResult result;
+    for (int t = 0; t < job.T; ++t) {
+        bool changed = step(job.rule, *current, *next);
+        if (until_end) {
+            std::swap(current, next);
+            continue;
+        }
+        if (!changed) {
+            result.stable_at = t;
+            result.period = 1;
+            break;
+        }
+        if (t > 0 && *next == *prev) {
+            result.stable_at = t - 1;
+            result.period = 2;
+            // `next` (t + 1) é igual a `prev` (t - 1): restam T - t - 1
+            // gerações depois de t + 1, e o estado final é t + 1 se forem pares.
+            if ((job.T - t - 1) % 2 == 0) current = next;
+            break;
+        }
+        std::swap(prev, current);
+        std::swap(current, next);
+    }
+
+    for (int y = 0; y < job.N; ++y) {
+        const std::uint8_t* row = current->row(y);
+        for (int x = 0; x < job.N; ++x) result.population += row[x];
+    }
+    result.state = current;
+    return result;
+}
+
+// Distribui as simulações entre P threads fixas, que retiram a próxima da
+// lista por um contador atômico e imprimem o resumo assim que terminam.
+int run_batch(int argc, char* argv[]) {
+    std::string path;
+    int P = 0;
+    bool verificar = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (opt.starts_with("--lote=")) path = opt.substr(7);
+        else if (opt.starts_with("--threads=")) P = std::stoi(opt.substr(10));
+        else if (opt == "--verificar") verificar = true;
+        else {
+            std::cerr << "Uso: " << argv[0] << " --lote=arquivo [--threads=P] [--verificar]\n";
+            return 1;
+        }
+    }
+    std::vector<Job> jobs;
+    if (!read_jobs(path, jobs)) return 1;
+    if (P <= 0) P = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "simulacao,dimensao,iteracoes,semente,regra,populacao,estavel_em,periodo,tempo_s\n";
+    std::atomic<int> cursor{0};
+    std::atomic<int> divergentes{0};
+    double cells = 0;
+    for (const auto& job : jobs) cells += static_cast<double>(job.N) * job.N * job.T;
+
+    auto inicio = std::chrono::steady_clock::now();
+    auto pool_worker = [&] {
+        JobBuffers buffers, reference;
+        std::ostringstream line;
+        for (int i; (i = cursor.fetch_add(1, std::memory_order_relaxed)) < static_cast<int>(jobs.size()); ) {
+            const Job& job = jobs[i];
+            auto t0 = std::chrono::steady_clock::now();
+            JobResult r = run_job(job, buffers);
+            std::chrono::duration<double> tempo = std::chrono::steady_clock::now() - t0;
+            if (verificar && !(*run_job(job, reference, true).state == *r.state)) {
+                divergentes.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(print_mtx);
+                std::cerr << "Verificacao: a simulacao " << job.index << " diverge da execucao completa\n";
+            }
+            line.str("");
+            line << job.index << ',' << job.N << ',' << job.T << ',' << job.seed << ',' << job.regra << ','
+                 << r.population << ',' << r.stable_at << ',' << r.period << ',' << tempo.count() << '\n';
+            std::lock_guard<std::mutex> lock(print_mtx);
+            std::cout << line.str() << std::flush;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int w = 0; w < P; ++w) threads.emplace_back(pool_worker);
+    for (auto& t : threads) t.join();
+    std::chrono::duration<double> tempo = std::chrono::steady_clock::now() - inicio;
+
+    std::cerr << "Lote: " << jobs.size() << " simulacoes em " << tempo.count() << " s ("
+              << jobs.size() / tempo.count() << " simulacoes/s, ate " << cells / tempo.count()
+              << " celulas/s) com " << P << " threads\n";
+    if (verificar) {
+        std::cerr << "Verificacao: " << (divergentes == 0 ? "OK" : "FALHOU") << '\n';
+        return divergentes == 0 ? 0 : 1;
+    }
     return 0;
 }
 
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]).starts_with("--lote="))
+        return run_batch(argc, argv);
+
+    Config cfg;
+    if (!parse_args(argc, argv, cfg)) {
+        std::cerr << "Uso: " << argv[0] << " --lote=arquivo [--threads=P] [--verificar]\n"
+                  << "     " << argv[0] << " <dimensao> <divisoes> <iteracoes>"
+                  << " [--modo=halo|isolado|tarefas] [--threads=P] [--largura=k] [--regra=B3/S23] [--numa] [--motor=celulas|bits|hashlife|hashlife-par]"
+                  << " [--memoria=MB] [--ativos] [--padrao=arquivo.rle|.cells]"
+                  << " [--restaurar=arquivo] [--salvar=arquivo] [--quadros=arquivo:K]"
+                  << " [--verificar] [--silencioso]\n";
+        return 1;
+    }
+
+    int N = cfg.N;
+    int T = cfg.T;
+    assert(N % cfg.D == 0);
+
+    Grid grid_inicio(N, N);
+    Grid grid_fim(N, N);
+    Timing timing;
+
+    if (!cfg.padrao.empty() && !load_pattern(cfg.padrao, grid_inicio))
+        return 1;
+    if (!cfg.restaurar.empty()) {
+        if (!load_checkpoint(cfg.restaurar, grid_inicio, cfg.geracao_inicial))
+            return 1;
+        std::cout << "Estado restaurado da geracao " << cfg.geracao_inicial << '\n';
+    }
+
+    bool hashlife = cfg.motor == Motor::HashLife || cfg.motor == Motor::HashLifePar;
+    if (hashlife)
+        run_hashlife(cfg, grid_inicio, grid_fim, timing);
+    else if (cfg.modo == Modo::Tarefas ? !run_tiles(cfg, grid_inicio, grid_fim, timing)
+                                       : !run_blocks(cfg, grid_inicio, grid_fim, timing))
+        return 1;
+    std::chrono::duration<double> tempo = timing.fim - timing.inicio;
+
+    if (!cfg.silencioso) {
+        std::cout << "Estado inicial:\n";
+        print_grid(grid_inicio);
+        std::cout << "Estado final apos " << T << " iteracoes:\n";
+        print_grid(grid_fim);
+    }
+
+    if (!cfg.salvar.empty()) {
+        if (!save_checkpoint(cfg.salvar, grid_fim, cfg.geracao_inicial + T))
+            return 1;
+        std::cout << "Checkpoint da geracao " << cfg.geracao_inicial + T << " salvo em " << cfg.salvar << '\n';
+    }
+
+    double celulas = static_cast<double>(N) * N * T;
+    std::cout << "Tempo: " << tempo.count() << " s ("
+              << (tempo.count() > 0 ? celulas / tempo.count() : 0.0) << " celulas/s)\n";
+
+    if (cfg.verificar) {
+        // Para o plano ilimitado do HashLife, a referência recebe uma margem de
+        // T+1 células mortas: nenhum efeito da borda alcança a janela em T gerações.
+        int margem = hashlife ? T + 1 : 0;
+        Grid atual(N + 2 * margem, N + 2 * margem), prox(N + 2 * margem, N + 2 * margem);
+        for (int y = 0; y < N; ++y)
+            std::memcpy(atual.row(y + margem) + margem, grid_inicio.row(y), N);
+        for (int t = 0; t < T; ++t) {
+            step(cfg.regra, atual, prox);
+            std::swap(atual, prox);
+        }
+        Grid janela(N, N);
+        for (int y = 0; y < N; ++y)
+            std::memcpy(janela.row(y), atual.row(y + margem) + margem, N);
+        std::cout << "Verificacao: " << (janela == grid_fim ? "OK" : "DIVERGENTE") << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+Canais de fronteira do Jogo da Vida.
+
+Cada par (bloco receptor, direção do vizinho) tem um `SpscChannel`: uma fila
+circular de capacidade fixa com exatamente um produtor (o vizinho) e um
+consumidor (o bloco). As mensagens vivem em compartimentos pré-alocados,
+reutilizados a cada geração: o produtor escreve a borda diretamente no
+compartimento obtido com `acquire` e o publica; o consumidor lê do próprio
+compartimento e o devolve com `release`. Não há cópias nem alocações no
+caminho crítico, e a sincronização se resume a dois índices atômicos.
+
+As esperas giram por alguns ciclos (com a instrução `pause`) antes de
+bloquear com `std::atomic::wait`, pois na troca de fronteiras o outro lado
+costuma estar a poucos microssegundos de distância.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// Posição do remetente de uma borda em relação ao bloco que a recebe. Na
+// ordem abaixo, a direção oposta a `d` é `7 - d`.
+enum class Direction : std::uint8_t {
+    TopLeft, Top, TopRight, Left, Right, BottomLeft, Bottom, BottomRight
+};
+
+inline Direction opposite(Direction d) {
+    return static_cast<Direction>(7 - static_cast<int>(d));
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+template <typename T, std::size_t Capacity = 2>
+class SpscChannel {
+    static constexpr int SPIN = 1024;
+
+    std::array<T, Capacity> slots;
+    alignas(64) std::atomic<std::size_t> head{0};  // próximo a consumir
+    alignas(64) std::atomic<std::size_t> tail{0};  // próximo a produzir
+
+    // Espera até que `index` deixe de valer `old`: primeiro girando, depois
+    // bloqueando. Devolve o novo valor.
+    static std::size_t await_change(std::atomic<std::size_t>& index, std::size_t old) {
+        for (int i = 0; i < SPIN; ++i) {
+            std::size_t v = index.load(std::memory_order_acquire);
+            if (v != old) return v;
+            cpu_relax();
+        }
+        index.wait(old, std::memory_order_acquire);
+        return index.load(std::memory_order_acquire);
+    }
+
+public:
+    explicit SpscChannel(const T& prototype) {
+        slots.fill(prototype);
+    }
+    SpscChannel(const SpscChannel&) = delete;
+    SpscChannel& operator=(const SpscChannel&) = delete;
+
+    // Produtor: compartimento livre para a próxima mensagem.
+    T& acquire() {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t h = head.load(std::memory_order_acquire);
+        while (t - h == Capacity) h = await_change(head, h);
+        return slots[t % Capacity];
+    }
+
+    void publish() {
+        tail.fetch_add(1, std::memory_order_release);
+        tail.notify_one();
+    }
+
+    // Consumidor: próxima mensagem publicada.
+    const T& receive() {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t t = tail.load(std::memory_order_acquire);
+        while (t == h) t = await_change(tail, t);
+        return slots[h % Capacity];
+    }
+
+    void release() {
+        head.fetch_add(1, std::memory_order_release);
+        head.notify_one();
+    }
+};
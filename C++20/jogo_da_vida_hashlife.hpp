@@ -0,0 +1,372 @@
+/*
+Motor HashLife para o Jogo da Vida (`--motor=hashlife` e `--motor=hashlife-par`).
+
+O universo é uma quadtree em que cada nó de nível k representa um quadrado de
+2^k x 2^k células. Nós idênticos são canonizados por uma tabela de espalhamento,
+de modo que regiões repetidas (em especial o espaço vazio) ocupam um único nó.
+Cada nó memoriza o seu futuro: o quadrado central de nível k-1 avançado
+2^(k-2) gerações. Com isso, padrões esparsos ou periódicos avançam milhões de
+gerações visitando poucos nós.
+
+A tabela é dividida em fatias (`Shard`), cada uma com seu próprio mutex, o que
+permite que o modo paralelo distribua entre threads as sub-árvores do nível mais
+alto. O orçamento de memória é um gatilho de coleta, não um limite rígido: ele
+é comparado, entre dois saltos de `advance`, com a memória em uso (nós vivos e
+vetores de baldes), e, se for excedido, os nós inalcançáveis a partir da raiz
+são coletados e os resultados memorizados são descartados. Um único salto pode
+ultrapassar o orçamento. A coleta reduz os vetores de baldes que ficaram
+esparsos; os nós coletados voltam à lista livre da sua fatia e
+são reaproveitados pelas alocações seguintes, mas os blocos (`CHUNK` nós) não
+são devolvidos ao sistema: `reserved()` informa o pico de memória reservada.
+
+Diferentemente dos motores por blocos, o HashLife simula o plano ilimitado; o
+grid N x N é apenas a janela observada.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "jogo_da_vida_grade.hpp"
+#include "jogo_da_vida_regra.hpp"
+
+class HashLife {
+public:
+    struct Node {
+        Node* nw = nullptr;
+        Node* ne = nullptr;
+        Node* sw = nullptr;
+        Node* se = nullptr;
+        std::atomic<Node*> result{nullptr};  // centro avançado 2^(level-2) gerações
+        std::atomic<Node*> slow{nullptr};    // centro avançado 2^step_j gerações
+        Node* next = nullptr;                // encadeamento na tabela
+        std::uint64_t population = 0;
+        std::uint64_t hash = 0;
+        int level = 0;
+        bool mark = false;
+    };
+
+    HashLife(const Grid& grid, std::size_t memory_budget, bool parallel, Rule rule = {})
+        : budget(memory_budget), parallel(parallel), rule(rule) {
+        leaf[0].population = 0;
+        leaf[1].population = 1;
+        empties.push_back(&leaf[0]);
+        for (int k = 1; k < MAX_LEVEL; ++k)
+            empties.push_back(join(empties.back(), empties.back(), empties.back(), empties.back()));
+
+        int level = 2;
+        while ((std::int64_t{1} << level) < std::max(grid.height(), grid.width())) ++level;
+        root = build(grid, 0, 0, level);
+    }
+
+    // Avança `generations` gerações, em saltos de potências de dois.
+    void advance(std::uint64_t generations) {
+        while (generations > 0) {
+            int j = 63 - __builtin_clzll(generations);
+            j = std::min(j, max_step);
+            step_pow2(j);
+            generations -= std::uint64_t{1} << j;
+
+            if (memory() > budget) {
+                collect();
+                // Se nem a coleta cabe no orçamento, saltos menores criam menos nós.
+                if (memory() > budget && max_step > 0) --max_step;
+            }
+        }
+    }
+
+    // Escreve em `grid` as células vivas da janela [0, altura) x [0, largura).
+    void extract(Grid& grid) const {
+        write(root, origin_y, origin_x, grid);
+    }
+
+    std::uint64_t population() const { return root->population; }
+    std::size_t nodes() const { return node_count.load(); }
+    // Memória em uso: nós vivos e vetores de baldes. É o valor comparado com o orçamento.
+    std::size_t memory() const { return node_count.load() * sizeof(Node) + bucket_bytes(); }
+    // Memória reservada: todos os blocos de nós já alocados, livres ou não, e os baldes.
+    std::size_t reserved() const {
+        std::size_t chunks = 0;
+        for (const Shard& s : shards) chunks += s.chunks.size();
+        return chunks * CHUNK * sizeof(Node) + bucket_bytes();
+    }
+    int collections() const { return gc_count; }
+
+private:
+    static constexpr int SHARDS = 64;
+    static constexpr int CHUNK = 4096;
+    static constexpr int MAX_LEVEL = 62;
+
+    struct Shard {
+        std::mutex mtx;
+        std::vector<Node*> buckets = std::vector<Node*>(1024);
+        std::size_t count = 0;
+        std::vector<std::unique_ptr<Node[]>> chunks;
+        int chunk_used = CHUNK;
+        Node* free_list = nullptr;
+    };
+
+    std::array<Shard, SHARDS> shards;
+    std::atomic<std::size_t> node_count{0};
+    Node leaf[2];
+    std::vector<Node*> empties;
+    Node* root = nullptr;
+    std::int64_t origin_y = 0, origin_x = 0;
+    std::size_t budget;
+    bool parallel;
+    Rule rule;
+    int max_step = MAX_LEVEL - 3;
+    int step_j = -1;
+    int gc_count = 0;
+
+    // Lido apenas entre saltos, quando nenhuma thread altera as fatias.
+    std::size_t bucket_bytes() const {
+        std::size_t buckets = 0;
+        for (const Shard& s : shards) buckets += s.buckets.size();
+        return buckets * sizeof(Node*);
+    }
+
+    static std::uint64_t hash_children(Node* a, Node* b, Node* c, Node* d) {
+        std::uint64_t h = reinterpret_cast<std::uintptr_t>(a);
+        h = h * 0x9E3779B97F4A7C15ULL + reinterpret_cast<std::uintptr_t>(b);
+        h = h * 0x9E3779B97F4A7C15ULL + reinterpret_cast<std::uintptr_t>(c);
+        h = h * 0x9E3779B97F4A7C15ULL + reinterpret_cast<std::uintptr_t>(d);
+        return h ^ (h >> 29);
+    }
+
+    Node* allocate(Shard& s) {
+        if (s.free_list) {
+            Node* n = s.free_list;
+            s.free_list = n->next;
+            return n;
+        }
+        if (s.chunk_used == CHUNK) {
+            s.chunks.emplace_back(new Node[CHUNK]);
+            s.chunk_used = 0;
+        }
+        return &s.chunks.back()[s.chunk_used++];
+    }
+
+    static void rehash(Shard& s, std::size_t size) {
+        std::vector<Node*> buckets(size);
+        for (Node* head : s.buckets) {
+            while (head) {
+                Node* n = head;
+                head = n->next;
+                Node*& b = buckets[n->hash & (buckets.size() - 1)];
+                n->next = b;
+                b = n;
+            }
+        }
+        s.buckets.swap(buckets);
+    }
+
+    // Devolve o nó canônico com os quatro filhos dados, criando-o se necessário.
+    Node* join(Node* nw, Node* ne, Node* sw, Node* se) {
+        std::uint64_t h = hash_children(nw, ne, sw, se);
+        Shard& s = shards[h >> 58];
+        std::lock_guard<std::mutex> lock(s.mtx);
+        Node*& bucket = s.buckets[h & (s.buckets.size() - 1)];
+        for (Node* n = bucket; n; n = n->next)
+            if (n->nw == nw && n->ne == ne && n->sw == sw && n->se == se)
+                return n;
+
+        Node* n = allocate(s);
+        n->nw = nw; n->ne = ne; n->sw = sw; n->se = se;
+        n->result.store(nullptr, std::memory_order_relaxed);
+        n->slow.store(nullptr, std::memory_order_relaxed);
+        n->population = nw->population + ne->population + sw->population + se->population;
+        n->hash = h;
+        n->level = nw->level + 1;
+        n->mark = false;
+        n->next = bucket;
+        bucket = n;
+        node_count.fetch_add(1, std::memory_order_relaxed);
+        if (++s.count > s.buckets.size()) rehash(s, s.buckets.size() * 2);
+        return n;
+    }
+
+    Node* build(const Grid& grid, std::int64_t y, std::int64_t x, int level) {
+        if (y >= grid.height() || x >= grid.width()) return empties[level];
+        if (level == 0) return &leaf[grid(y, x) ? 1 : 0];
+        std::int64_t half = std::int64_t{1} << (level - 1);
+        return join(build(grid, y, x, level - 1), build(grid, y, x + half, level - 1),
+                    build(grid, y + half, x, level - 1), build(grid, y + half, x + half, level - 1));
+    }
+
+    void write(const Node* n, std::int64_t y, std::int64_t x, Grid& grid) const {
+        std::int64_t size = std::int64_t{1} << n->level;
+        if (n->population == 0 || y >= grid.height() || x >= grid.width() || y + size <= 0 || x + size <= 0)
+            return;
+        if (n->level == 0) {
+            grid(y, x) = 1;
+            return;
+        }
+        std::int64_t half = size / 2;
+        write(n->nw, y, x, grid);
+        write(n->ne, y, x + half, grid);
+        write(n->sw, y + half, x, grid);
+        write(n->se, y + half, x + half, grid);
+    }
+
+    Node* center(Node* n) {
+        return join(n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+    }
+
+    // Nó de nível 2 (4x4): calcula diretamente a geração seguinte do centro 2x2.
+    Node* base_case(Node* n) {
+        int cells[4][4];
+        Node* quads[2][2] = {{n->nw, n->ne}, {n->sw, n->se}};
+        for (int qy = 0; qy < 2; ++qy)
+            for (int qx = 0; qx < 2; ++qx) {
+                Node* q = quads[qy][qx];
+                cells[2*qy][2*qx] = q->nw->population;
+                cells[2*qy][2*qx+1] = q->ne->population;
+                cells[2*qy+1][2*qx] = q->sw->population;
+                cells[2*qy+1][2*qx+1] = q->se->population;
+            }
+        Node* out[2][2];
+        for (int y = 1; y <= 2; ++y)
+            for (int x = 1; x <= 2; ++x) {
+                int count = 0;
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx)
+                        if (dy || dx) count += cells[y + dy][x + dx];
+                bool alive = rule.next(count, cells[y][x]);
+                out[y-1][x-1] = &leaf[alive];
+            }
+        return join(out[0][0], out[0][1], out[1][0], out[1][1]);
+    }
+
+    // Aplica `f` aos elementos de `in`, em threads distintas se `spawn`.
+    template <std::size_t K, typename F>
+    static std::array<Node*, K> map(const std::array<Node*, K>& in, bool spawn, F f) {
+        std::array<Node*, K> out;
+        if (!spawn) {
+            for (std::size_t i = 0; i < K; ++i) out[i] = f(in[i]);
+            return out;
+        }
+        std::array<std::future<Node*>, K> futures;
+        for (std::size_t i = 0; i < K; ++i)
+            futures[i] = std::async(std::launch::async, f, in[i]);
+        for (std::size_t i = 0; i < K; ++i) out[i] = futures[i].get();
+        return out;
+    }
+
+    // Quadrado central (nível k-1) de `n` (nível k) avançado 2^j gerações, j <= k-2.
+    // Com `par_depth` > 0 as sub-árvores deste nível são calculadas em paralelo.
+    Node* successor(Node* n, int j, int par_depth) {
+        int k = n->level;
+        if (n->population == 0) return empties[k - 1];
+        bool full = j == k - 2;
+        std::atomic<Node*>& memo = full ? n->result : n->slow;
+        if (Node* r = memo.load(std::memory_order_acquire)) return r;
+
+        Node* r;
+        if (k == 2) {
+            r = base_case(n);
+        } else {
+            std::array<Node*, 9> sub = {
+                n->nw, join(n->nw->ne, n->ne->nw, n->nw->se, n->ne->sw), n->ne,
+                join(n->nw->sw, n->nw->se, n->sw->nw, n->sw->ne), center(n),
+                join(n->ne->sw, n->ne->se, n->se->nw, n->se->ne),
+                n->sw, join(n->sw->ne, n->se->nw, n->sw->se, n->se->sw), n->se,
+            };
+            bool spawn = par_depth > 0;
+            auto half = full
+                ? map(sub, spawn, [&](Node* m) { return successor(m, k - 3, par_depth - 1); })
+                : map(sub, false, [&](Node* m) { return center(m); });
+            std::array<Node*, 4> quads = {
+                join(half[0], half[1], half[3], half[4]), join(half[1], half[2], half[4], half[5]),
+                join(half[3], half[4], half[6], half[7]), join(half[4], half[5], half[7], half[8]),
+            };
+            int jj = full ? k - 3 : j;
+            auto res = map(quads, spawn, [&](Node* m) { return successor(m, jj, par_depth - 1); });
+            r = join(res[0], res[1], res[2], res[3]);
+        }
+        memo.store(r, std::memory_order_release);
+        return r;
+    }
+
+    void expand() {
+        Node* e = empties[root->level - 1];
+        root = join(join(e, e, e, root->nw), join(e, e, root->ne, e),
+                    join(e, root->sw, e, e), join(root->se, e, e, e));
+        std::int64_t shift = std::int64_t{1} << (root->level - 2);
+        origin_y -= shift;
+        origin_x -= shift;
+    }
+
+    // Todas as células vivas estão no quadrado central de metade do lado?
+    bool centered() const {
+        return root->population == root->nw->se->population + root->ne->sw->population
+                                 + root->sw->ne->population + root->se->nw->population;
+    }
+
+    template <typename F>
+    void for_each_node(F f) {
+        for (Shard& s : shards)
+            for (Node* head : s.buckets)
+                for (Node* n = head; n; n = n->next) f(n);
+    }
+
+    void step_pow2(int j) {
+        if (j != step_j) {
+            // Os resultados de passo reduzido valem apenas para um j.
+            for_each_node([](Node* n) { n->slow.store(nullptr, std::memory_order_relaxed); });
+            step_j = j;
+        }
+        while (root->level < j + 2 || !centered()) expand();
+        expand();
+        std::int64_t shift = std::int64_t{1} << (root->level - 2);
+        root = successor(root, j, parallel ? 1 : 0);
+        origin_y += shift;
+        origin_x += shift;
+    }
+
+    // Coleta os nós inalcançáveis a partir da raiz e das constantes vazias.
+    void collect() {
+        std::vector<Node*> stack(empties.begin(), empties.end());
+        stack.push_back(root);
+        while (!stack.empty()) {
+            Node* n = stack.back();
+            stack.pop_back();
+            if (n->mark || n->level == 0) continue;
+            n->mark = true;
+            stack.push_back(n->nw);
+            stack.push_back(n->ne);
+            stack.push_back(n->sw);
+            stack.push_back(n->se);
+        }
+        for (Shard& s : shards) {
+            for (Node*& head : s.buckets) {
+                Node** link = &head;
+                while (Node* n = *link) {
+                    if (n->mark) {
+                        n->mark = false;
+                        n->result.store(nullptr, std::memory_order_relaxed);
+                        n->slow.store(nullptr, std::memory_order_relaxed);
+                        link = &n->next;
+                    } else {
+                        *link = n->next;
+                        n->next = s.free_list;
+                        s.free_list = n;
+                        --s.count;
+                        node_count.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+            // Devolve os baldes que sobraram depois da coleta.
+            std::size_t size = s.buckets.size();
+            while (size > 1024 && s.count < size / 4) size /= 2;
+            if (size < s.buckets.size()) rehash(s, size);
+        }
+        ++gc_count;
+    }
+};
@@ -0,0 +1,318 @@
+/*
+Entrada e saída do Jogo da Vida.
+
+- `load_pattern`: carrega um padrão nos formatos RLE (`.rle`) ou texto simples
+  (`.cells`, com `.` para célula morta e `O` ou `*` para viva), centralizado no grid.
+- `save_checkpoint` / `load_checkpoint`: grava e restaura o grid completo em um
+  arquivo binário mapeado em memória (`mmap`), com 8 células por byte e o
+  número da geração, para que execuções longas possam ser retomadas.
+- `FrameWriter`: grava, em uma thread própria, quadros a cada K gerações. Cada
+  quadro contém apenas as sequências de células que mudaram desde o quadro
+  anterior, codificadas como pares (distância, comprimento) em inteiros de
+  tamanho variável (LEB128).
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jogo_da_vida_grade.hpp"
+
+// Aplica `f(y0, y1)` a faixas de linhas [0, rows), uma por thread.
+template <typename F>
+void parallel_rows(int rows, F f) {
+    int n = std::max(1, std::min<int>(std::thread::hardware_concurrency(), rows));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n; ++i)
+        threads.emplace_back(f, rows * i / n, rows * (i + 1) / n);
+    for (auto& t : threads) t.join();
+}
+
+inline bool load_pattern(const std::string& path, Grid& grid) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Erro ao abrir o padrao " << path << '\n';
+        return false;
+    }
+
+    std::vector<std::pair<int, int>> cells;
+    std::string line;
+    bool rle = path.ends_with(".rle");
+    int y = 0, x = 0, count = 0;
+    bool done = false;  // o RLE termina em '!'; o que vier depois é comentário
+    while (!done && std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.starts_with("#") || (!rle && line.starts_with("!"))) continue;
+        if (line.starts_with("x ") || line.starts_with("x=")) {
+            rle = true;  // cabeçalho "x = m, y = n, rule = ..."
+            continue;
+        }
+        if (!rle) {
+            for (int i = 0; i < static_cast<int>(line.size()); ++i)
+                if (line[i] == 'O' || line[i] == '*') cells.emplace_back(y, i);
+            ++y;
+            continue;
+        }
+        for (char c : line) {
+            if (c >= '0' && c <= '9') {
+                count = count * 10 + (c - '0');
+                continue;
+            }
+            int n = count ? count : 1;
+            count = 0;
+            if (c == 'b' || c == '.') x += n;
+            else if (c == '$') { y += n; x = 0; }
+            else if (c == '!') {
+                done = true;
+                break;
+            }
+            else if (std::isalpha(static_cast<unsigned char>(c))) {
+                for (int i = 0; i < n; ++i) cells.emplace_back(y, x++);
+            }
+        }
+    }
+
+    int h = 0, w = 0;
+    for (auto [cy, cx] : cells) {
+        h = std::max(h, cy + 1);
+        w = std::max(w, cx + 1);
+    }
+    if (h > grid.height() || w > grid.width()) {
+        std::cerr << "Padrao " << path << " (" << w << "x" << h << ") nao cabe no grid\n";
+        return false;
+    }
+    int oy = (grid.height() - h) / 2, ox = (grid.width() - w) / 2;
+    for (auto [cy, cx] : cells)
+        grid(oy + cy, ox + cx) = 1;
+    return true;
+}
+
+struct CheckpointHeader {
+    char magic[8];
+    std::uint32_t height, width;
+    std::uint64_t generation;
+};
+
+constexpr char CHECKPOINT_MAGIC[8] = {'J', 'D', 'V', 'C', 'K', 'P', 'T', '1'};
+
+// Compacta 8 células (bytes 0/1) em um byte, célula x no bit x % 8.
+inline std::uint8_t pack8(const std::uint8_t* cells) {
+    std::uint64_t v;
+    std::memcpy(&v, cells, 8);
+    return (v * 0x0102040810204080ULL) >> 56;
+}
+
+inline bool save_checkpoint(const std::string& path, const Grid& grid, std::uint64_t generation) {
+    std::size_t row_bytes = (grid.width() + 7) / 8;
+    std::size_t size = sizeof(CheckpointHeader) + row_bytes * grid.height();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ::ftruncate(fd, size) != 0) {
+        std::cerr << "Erro ao criar o checkpoint " << path << '\n';
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Erro ao mapear o checkpoint " << path << '\n';
+        return false;
+    }
+
+    auto* header = static_cast<CheckpointHeader*>(map);
+    std::memcpy(header->magic, CHECKPOINT_MAGIC, sizeof CHECKPOINT_MAGIC);
+    header->height = grid.height();
+    header->width = grid.width();
+    header->generation = generation;
+    auto* bits = static_cast<std::uint8_t*>(map) + sizeof(CheckpointHeader);
+    parallel_rows(grid.height(), [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const std::uint8_t* row = grid.row(y);
+            std::uint8_t* out = bits + y * row_bytes;
+            int x = 0;
+            for (; x + 8 <= grid.width(); x += 8) out[x / 8] = pack8(row + x);
+            if (x < grid.width()) {
+                out[x / 8] = 0;
+                for (int i = x; i < grid.width(); ++i) out[x / 8] |= row[i] << (i - x);
+            }
+        }
+    });
+    ::munmap(map, size);
+    return true;
+}
+
+inline bool load_checkpoint(const std::string& path, Grid& grid, std::uint64_t& generation) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CheckpointHeader))) {
+        std::cerr << "Erro ao abrir o checkpoint " << path << '\n';
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    std::size_t size = st.st_size;
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Erro ao mapear o checkpoint " << path << '\n';
+        return false;
+    }
+
+    const auto* header = static_cast<const CheckpointHeader*>(map);
+    std::size_t row_bytes = (header->width + 7) / 8;
+    bool valid = std::memcmp(header->magic, CHECKPOINT_MAGIC, sizeof CHECKPOINT_MAGIC) == 0
+              && size == sizeof(CheckpointHeader) + row_bytes * header->height;
+    if (!valid || static_cast<int>(header->height) != grid.height()
+               || static_cast<int>(header->width) != grid.width()) {
+        std::cerr << "Checkpoint " << path << (valid ? " tem dimensao diferente do grid\n" : " invalido\n");
+        ::munmap(map, size);
+        return false;
+    }
+
+    generation = header->generation;
+    const auto* bits = static_cast<const std::uint8_t*>(map) + sizeof(CheckpointHeader);
+    parallel_rows(grid.height(), [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            std::uint8_t* row = grid.row(y);
+            const std::uint8_t* in = bits + y * row_bytes;
+            for (int x = 0; x < grid.width(); ++x) row[x] = (in[x / 8] >> (x % 8)) & 1;
+        }
+    });
+    ::munmap(map, size);
+    return true;
+}
+
+// Grava quadros em segundo plano. As threads de cálculo preenchem `buffer()`
+// e `submit` o entrega ao escritor, trocando de buffer; no máximo um quadro
+// fica pendente, de modo que o cálculo só espera se o disco ficar para trás.
+class FrameWriter {
+    std::FILE* out;
+    int interval_;
+    Grid buffers[2], previous;
+    int filling = 0, pending_index = 0;
+    std::uint64_t pending_generation = 0;
+    bool pending = false, done = false;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread writer;
+
+    std::vector<std::uint8_t> bytes;  // quadro codificado, gravado com um único fwrite
+
+    void put_varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            bytes.push_back(static_cast<std::uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        bytes.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    // Sequências de células diferentes entre `frame` e o quadro anterior, em
+    // ordem de linha, como pares (distância desde o fim da anterior, comprimento).
+    void encode(const Grid& frame, std::uint64_t generation) {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> runs;
+        std::uint64_t last_end = 0;
+        int W = frame.width();
+        for (int y = 0; y < frame.height(); ++y) {
+            const std::uint8_t* a = frame.row(y);
+            const std::uint8_t* b = previous.row(y);
+            std::uint64_t base = static_cast<std::uint64_t>(y) * W;
+            int x = 0;
+            while (x < W) {
+                if (x + 8 <= W && std::memcmp(a + x, b + x, 8) == 0) { x += 8; continue; }
+                if (a[x] == b[x]) { ++x; continue; }
+                int start = x;
+                while (x < W && a[x] != b[x]) ++x;
+                if (!runs.empty() && runs.back().first + runs.back().second == base + start)
+                    runs.back().second += x - start;  // continua da linha anterior
+                else
+                    runs.emplace_back(base + start, x - start);
+            }
+            std::memcpy(previous.row(y), a, W);
+        }
+        bytes.clear();
+        put_varint(runs.size());
+        for (auto [start, length] : runs) {
+            put_varint(start - last_end);
+            put_varint(length);
+            last_end = start + length;
+        }
+        std::fwrite(&generation, sizeof generation, 1, out);
+        std::fwrite(bytes.data(), 1, bytes.size(), out);
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [&] { return pending || done; });
+            if (!pending) break;
+            int index = pending_index;
+            std::uint64_t generation = pending_generation;
+            lock.unlock();
+            encode(buffers[index], generation);
+            lock.lock();
+            pending = false;
+            cv.notify_all();
+        }
+    }
+
+    FrameWriter(std::FILE* f, int height, int width, int interval)
+        : out(f), interval_(interval), buffers{Grid(height, width), Grid(height, width)},
+          previous(height, width) {
+        static char magic[8] = {'J', 'D', 'V', 'Q', 'U', 'A', 'D', '1'};
+        std::uint32_t dims[2] = {static_cast<std::uint32_t>(height), static_cast<std::uint32_t>(width)};
+        std::fwrite(magic, 1, sizeof magic, out);
+        std::fwrite(dims, sizeof dims[0], 2, out);
+        writer = std::thread(&FrameWriter::loop, this);
+    }
+
+public:
+    static std::unique_ptr<FrameWriter> open(const std::string& path, int height, int width, int interval) {
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) {
+            std::cerr << "Erro ao criar o arquivo de quadros " << path << '\n';
+            return nullptr;
+        }
+        std::setvbuf(f, nullptr, _IOFBF, 1 << 20);
+        return std::unique_ptr<FrameWriter>(new FrameWriter(f, height, width, interval));
+    }
+
+    ~FrameWriter() {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return !pending; });
+            done = true;
+        }
+        cv.notify_all();
+        writer.join();
+        std::fclose(out);
+    }
+
+    int interval() const { return interval_; }
+    Grid& buffer() { return buffers[filling]; }
+
+    void submit(std::uint64_t generation) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&] { return !pending; });
+        pending = true;
+        pending_index = filling;
+        pending_generation = generation;
+        filling ^= 1;
+        cv.notify_all();
+    }
+};
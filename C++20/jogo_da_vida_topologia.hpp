@@ -0,0 +1,163 @@
+/*
+Topologia da máquina para o modo `--numa` do Jogo da Vida.
+
+`Topology::detect` lê de `/sys/devices/system` as CPUs ativas (restritas às que
+o processo pode usar), o nó NUMA, o soquete e o grupo de cache de último nível
+(L3) de cada uma, e as ordena de modo que CPUs consecutivas compartilhem cache
+e nó. `Topology::assign` percorre os blocos em ordem de Morton (curva em Z),
+que mantém blocos vizinhos próximos na sequência, e entrega a cada bloco uma
+CPU dessa ordem: blocos vizinhos caem em núcleos que compartilham a L3 e,
+portanto, o nó.
+
+`pin_current_thread` fixa a thread chamadora em uma CPU. Como o Linux aloca
+cada página no nó da primeira thread que a escreve ("first touch"), um bloco
+criado pela própria thread depois de fixada fica no nó dela; `page_node`
+confirma, com a chamada de sistema `move_pages`, em que nó está a maior parte
+das páginas do bloco.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+class Topology {
+public:
+    struct Cpu {
+        int id = 0;
+        int node = 0;      // nó NUMA
+        int package = 0;   // soquete
+        int cache = 0;     // menor CPU que compartilha a cache de último nível
+        int core = 0;
+    };
+
+    // Interpreta listas do sysfs como "0-3,8-11".
+    static std::vector<int> parse_list(const std::string& text) {
+        std::vector<int> ids;
+        std::stringstream in(text);
+        std::string range;
+        while (std::getline(in, range, ',')) {
+            if (range.empty() || range == "\n") continue;
+            auto dash = range.find('-');
+            int lo = std::stoi(range.substr(0, dash));
+            int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+            for (int i = lo; i <= hi; ++i) ids.push_back(i);
+        }
+        return ids;
+    }
+
+    static Topology detect() {
+        const std::string base = "/sys/devices/system/";
+        Topology topo;
+        std::vector<int> online = parse_list(read(base + "cpu/online"));
+        if (online.empty()) {
+            // Sem sysfs: uma CPU lógica por hardware_concurrency(), nó único.
+            for (int i = 0; i < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); ++i)
+                online.push_back(i);
+        }
+        cpu_set_t allowed;
+        bool restricted = ::sched_getaffinity(0, sizeof allowed, &allowed) == 0;
+        for (int id : online) {
+            if (restricted && !CPU_ISSET(id, &allowed)) continue;  // fora do cpuset do processo
+            std::string cpu = base + "cpu/cpu" + std::to_string(id) + "/";
+            Cpu c;
+            c.id = id;
+            c.package = read_int(cpu + "topology/physical_package_id", 0);
+            c.core = read_int(cpu + "topology/core_id", id);
+            std::vector<int> llc = parse_list(read(cpu + "cache/index3/shared_cpu_list"));
+            c.cache = llc.empty() ? -1 - c.package : llc.front();
+            topo.cpus.push_back(c);
+        }
+        for (int node : parse_list(read(base + "node/online"))) {
+            for (int id : parse_list(read(base + "node/node" + std::to_string(node) + "/cpulist")))
+                for (auto& c : topo.cpus)
+                    if (c.id == id) c.node = node;
+            topo.nodes = std::max(topo.nodes, node + 1);
+        }
+        std::sort(topo.cpus.begin(), topo.cpus.end(), [](const Cpu& a, const Cpu& b) {
+            return std::tie(a.node, a.package, a.cache, a.core, a.id)
+                 < std::tie(b.node, b.package, b.cache, b.core, b.id);
+        });
+        return topo;
+    }
+
+    // CPU de cada um dos rows x cols blocos, indexada pelo id do bloco; vazio
+    // se nenhuma CPU foi encontrada.
+    std::vector<Cpu> assign(int rows, int cols) const {
+        if (cpus.empty()) return {};
+        std::vector<int> order(rows * cols);
+        for (int i = 0; i < rows * cols; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return morton(a / cols, a % cols) < morton(b / cols, b % cols);
+        });
+        std::vector<Cpu> result(rows * cols);
+        std::size_t n = order.size();
+        for (std::size_t rank = 0; rank < n; ++rank)
+            result[order[rank]] = cpus[rank * cpus.size() / n];
+        return result;
+    }
+
+    std::vector<Cpu> cpus;
+    int nodes = 1;
+
+private:
+    static std::string read(const std::string& path) {
+        std::ifstream in(path);
+        std::string text;
+        std::getline(in, text);
+        return text;
+    }
+
+    static int read_int(const std::string& path, int fallback) {
+        std::string text = read(path);
+        return text.empty() ? fallback : std::stoi(text);
+    }
+
+    // Entrelaça os bits de y e x.
+    static std::uint64_t morton(std::uint32_t y, std::uint32_t x) {
+        std::uint64_t code = 0;
+        for (int b = 0; b < 32; ++b)
+            code |= (std::uint64_t{(y >> b) & 1} << (2 * b + 1)) | (std::uint64_t{(x >> b) & 1} << (2 * b));
+        return code;
+    }
+};
+
+inline bool pin_current_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof set, &set) == 0;
+}
+
+// Nó NUMA em que está a maior parte das páginas de [p, p + bytes), ou -1 se o
+// núcleo não informar o de nenhuma.
+inline int page_node(const void* p, std::size_t bytes) {
+    std::uintptr_t page_size = ::sysconf(_SC_PAGESIZE);
+    std::uintptr_t first = reinterpret_cast<std::uintptr_t>(p) & ~(page_size - 1);
+    std::uintptr_t last = reinterpret_cast<std::uintptr_t>(p) + std::max<std::size_t>(bytes, 1) - 1;
+    std::vector<void*> pages;
+    for (std::uintptr_t a = first; a <= last; a += page_size) pages.push_back(reinterpret_cast<void*>(a));
+    std::vector<int> status(pages.size(), -1);
+    // Sem nós de destino, move_pages apenas consulta a localização das páginas.
+    if (::syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) return -1;
+    std::vector<int> count;
+    for (int node : status) {
+        if (node < 0) continue;
+        if (node >= static_cast<int>(count.size())) count.resize(node + 1);
+        ++count[node];
+    }
+    auto most = std::max_element(count.begin(), count.end());
+    return most == count.end() || *most == 0 ? -1 : static_cast<int>(most - count.begin());
+}
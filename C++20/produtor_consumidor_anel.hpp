@@ -0,0 +1,211 @@
+/*
+Fila circular limitada para múltiplos produtores e múltiplos consumidores
+(MPMC), sem travas, usada pela opção `--anel` dos programas produtor/consumidor.
+
+É o algoritmo de Dmitry Vyukov: cada posição do anel guarda, além do valor, um
+número de sequência que diz de quem é a vez. A posição `i` está livre para o
+produtor que obteve o bilhete `pos` (com `pos % capacidade == i`) quando a
+sequência vale `pos`, e pronta para o consumidor do mesmo bilhete quando vale
+`pos + 1`; depois de consumida, passa a valer `pos + capacidade`, o bilhete da
+próxima volta. Produtores disputam apenas a cauda e consumidores apenas a
+cabeça, cada uma com um `compare_exchange` e na sua própria linha de cache, de
+modo que produtores e consumidores não se atrapalham e uma operação não
+bloqueia as demais.
+
+A capacidade é fixa (arredondada para potência de 2): com o anel cheio,
+`push` espera até um consumidor liberar espaço, o que limita a memória quando
+os produtores são mais rápidos que os consumidores ("backpressure"). Há três
+formas de cada operação: `tentar_*` (devolve `false` de imediato), a
+bloqueante e `*_por` (desiste depois de um tempo). As bloqueantes usam a
+espera adaptativa de `produtor_consumidor_espera.hpp`: consumidores esperam em
+`itens` e produtores em `espaco`, e cada inserção ou retirada bem-sucedida
+avisa o lado oposto, o que só custa uma chamada de sistema se houver alguém
+adormecido.
+
+`push_n` e `pop_ate` movem lotes: reservam, com um único `compare_exchange`,
+todas as posições consecutivas prontas (até o tamanho do lote), de modo que a
+disputa pela cauda ou pela cabeça é paga uma vez por lote e não por item.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <thread>
+
+#include "produtor_consumidor_espera.hpp"
+
+template <typename T>
+class AnelMPMC {
+    struct Posicao {
+        std::atomic<size_t> sequencia;
+        T valor;
+    };
+
+    std::unique_ptr<Posicao[]> posicoes;
+    size_t mascara;
+    alignas(64) std::atomic<size_t> cauda{0};   // próximo bilhete de produtor
+    alignas(64) std::atomic<size_t> cabeca{0};  // próximo bilhete de consumidor
+    char separador[64 - sizeof(std::atomic<size_t>)];  // isola a cabeça do que vier depois
+    Espera itens_, espaco;
+
+public:
+    explicit AnelMPMC(size_t capacidade, int giros = Espera::giros_padrao(), bool medir = false)
+        : posicoes(new Posicao[std::bit_ceil(std::max<size_t>(capacidade, 2))]),
+          mascara(std::bit_ceil(std::max<size_t>(capacidade, 2)) - 1),
+          itens_(giros, medir), espaco(giros, medir) {
+        for (size_t i = 0; i <= mascara; ++i) posicoes[i].sequencia.store(i, std::memory_order_relaxed);
+    }
+    AnelMPMC(const AnelMPMC&) = delete;
+    AnelMPMC& operator=(const AnelMPMC&) = delete;
+
+    size_t capacidade() const { return mascara + 1; }
+
+    // Espera dos consumidores, para o relatório de latência.
+    Espera& itens() { return itens_; }
+
+    bool tentar_push(const T& valor) {
+        size_t pos = cauda.load(std::memory_order_relaxed);
+        while (true) {
+            Posicao& p = posicoes[pos & mascara];
+            size_t seq = p.sequencia.load(std::memory_order_acquire);
+            auto diferenca = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diferenca == 0) {
+                if (cauda.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    p.valor = valor;
+                    p.sequencia.store(pos + 1, std::memory_order_release);
+                    itens_.notificar();
+                    return true;
+                }
+            } else if (diferenca < 0) {
+                return false;  // cheio: a posição ainda não foi consumida na volta anterior
+            } else {
+                pos = cauda.load(std::memory_order_relaxed);  // outro produtor levou o bilhete
+            }
+        }
+    }
+
+    bool tentar_pop(T& valor) {
+        size_t pos = cabeca.load(std::memory_order_relaxed);
+        while (true) {
+            Posicao& p = posicoes[pos & mascara];
+            size_t seq = p.sequencia.load(std::memory_order_acquire);
+            auto diferenca = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diferenca == 0) {
+                if (cabeca.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    valor = std::move(p.valor);
+                    p.sequencia.store(pos + mascara + 1, std::memory_order_release);
+                    espaco.notificar();
+                    return true;
+                }
+            } else if (diferenca < 0) {
+                return false;  // vazio
+            } else {
+                pos = cabeca.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Insere até `n` itens em posições consecutivas; devolve quantos inseriu.
+    size_t tentar_push_n(const T* itens, size_t n) {
+        size_t pos = cauda.load(std::memory_order_relaxed);
+        while (n > 0) {
+            size_t k = 0;
+            while (k < n && posicoes[(pos + k) & mascara].sequencia.load(std::memory_order_acquire) == pos + k) ++k;
+            if (k == 0) {
+                size_t seq = posicoes[pos & mascara].sequencia.load(std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos) < 0) return 0;
+                pos = cauda.load(std::memory_order_relaxed);
+            } else if (cauda.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < k; ++i) {
+                    Posicao& p = posicoes[(pos + i) & mascara];
+                    p.valor = itens[i];
+                    p.sequencia.store(pos + i + 1, std::memory_order_release);
+                }
+                itens_.notificar();
+                return k;
+            }
+        }
+        return 0;
+    }
+
+    // Retira até `max` itens de posições consecutivas; devolve quantos retirou.
+    size_t tentar_pop_ate(T* destino, size_t max) {
+        size_t pos = cabeca.load(std::memory_order_relaxed);
+        while (max > 0) {
+            size_t k = 0;
+            while (k < max && posicoes[(pos + k) & mascara].sequencia.load(std::memory_order_acquire) == pos + k + 1) ++k;
+            if (k == 0) {
+                size_t seq = posicoes[pos & mascara].sequencia.load(std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1) < 0) return 0;
+                pos = cabeca.load(std::memory_order_relaxed);
+            } else if (cabeca.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < k; ++i) {
+                    Posicao& p = posicoes[(pos + i) & mascara];
+                    destino[i] = std::move(p.valor);
+                    p.sequencia.store(pos + i + mascara + 1, std::memory_order_release);
+                }
+                espaco.notificar();
+                return k;
+            }
+        }
+        return 0;
+    }
+
+    void push(const T& valor) {
+        espaco.esperar([&] { return tentar_push(valor); });
+    }
+
+    void pop(T& valor) {
+        itens_.esperar([&] { return tentar_pop(valor); });
+    }
+
+    // Como `pop`, mas desiste quando `parada` é pedida com o anel vazio;
+    // devolve se retirou um item.
+    bool pop(T& valor, std::stop_token parada) {
+        std::stop_callback acordar(parada, [&] { itens_.notificar_todos(); });
+        bool retirou = false;
+        itens_.esperar([&] { return (retirou = tentar_pop(valor)) || parada.stop_requested(); });
+        return retirou || tentar_pop(valor);
+    }
+
+    // Insere os `n` itens, esperando por espaço quando preciso.
+    void push_n(const T* itens, size_t n) {
+        for (size_t feitos = 0; feitos < n; ) {
+            espaco.esperar([&] {
+                size_t k = tentar_push_n(itens + feitos, n - feitos);
+                feitos += k;
+                return k > 0;
+            });
+        }
+    }
+
+    // Espera pelo primeiro item e retira até `max`. Com `espera` positiva,
+    // continua juntando itens por até esse tempo enquanto o lote não se completa.
+    template <typename Rep = long, typename Period = std::ratio<1>>
+    size_t pop_ate(T* destino, size_t max, std::chrono::duration<Rep, Period> espera = {}) {
+        size_t n = 0;
+        itens_.esperar([&] { return (n = tentar_pop_ate(destino, max)) > 0; });
+        auto prazo = std::chrono::steady_clock::now() + espera;
+        while (n < max && itens_.esperar_ate([&] { return tentar_pop_ate(destino + n, 1) > 0; }, prazo)) {
+            n++;
+            n += tentar_pop_ate(destino + n, max - n);
+        }
+        return n;
+    }
+
+    template <typename Rep, typename Period>
+    bool push_por(const T& valor, std::chrono::duration<Rep, Period> limite) {
+        return espaco.esperar_ate([&] { return tentar_push(valor); }, std::chrono::steady_clock::now() + limite);
+    }
+
+    template <typename Rep, typename Period>
+    bool pop_por(T& valor, std::chrono::duration<Rep, Period> limite) {
+        return itens_.esperar_ate([&] { return tentar_pop(valor); }, std::chrono::steady_clock::now() + limite);
+    }
+};
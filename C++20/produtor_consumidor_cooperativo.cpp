@@ -21,10 +21,22 @@ Exemplo de uso:
 
 Esse comando cria 2 produtores, cada um gerando 5 números primos, e 2 consumidores para processar os dados.
 
+Por padrão, os primos vêm de um crivo segmentado compartilhado (`produtor_consumidor_primos.hpp`) e cada produtor recebe primos distintos; `--primos=divisao` restaura o comportamento original, em que cada produtor encontra os primos a partir de 2 por divisão.
+
+Opcionalmente, `--anel[=capacidade]` troca a fila protegida pelo mutex por um anel limitado sem travas (`produtor_consumidor_anel.hpp`, capacidade padrão 1024). Ao final, o programa informa a vazão em itens por segundo.
+
+`--espera=adaptativa` mantém o buffer com mutex, mas troca a variável de condição pela espera adaptativa de `produtor_consumidor_espera.hpp`, que o anel também usa. `--giros=N` define quantas vezes um consumidor ocioso testa a fila antes de dormir (padrão 256, ou 0 com um único processador), e `--latencia` mede o tempo entre a chegada de um item e o despertar do consumidor nessas duas formas de espera, informando os percentis ao final.
+
+`--silencioso` omite as mensagens de cada item produzido ou consumido, e `--amostra=N` mantém só uma a cada N delas por thread; as mensagens de conclusão são sempre escritas.
+
 Recursos de Programação Concorrente Utilizados
 
 - **`std::jthread`**: threads com gerenciamento automático e suporte embutido a cancelamento cooperativo via `stop_token`.
 - **`std::mutex` e `std::condition_variable`**: controle de acesso ao buffer compartilhado (`std::queue<int> buffer`) e sincronização entre produtores e consumidores.
+- **Fila circular MPMC sem travas** (opção `--anel`): os produtores inserem com `push`, que espera enquanto o anel está cheio, e os consumidores retiram com a versão de `pop` que recebe o `stop_token`; um `std::stop_callback` acorda os consumidores adormecidos quando a parada é pedida. Os consumidores só param com o anel vazio.
+- **Espera adaptativa** (opção `--espera=adaptativa`): o consumidor gira por alguns instantes e depois dorme com `std::atomic::wait`; o produtor avisa com `notify_one`, que só chega ao sistema operacional se houver consumidor adormecido, ao contrário de `cv.notify_one()`. O pedido de parada entra na condição de espera, e a thread principal acorda todos os consumidores depois de pedi-lo.
+- **Registro assíncrono** (`produtor_consumidor_registro.hpp`): em vez de escrever em `std::cout`, cada thread anota as suas mensagens em um anel próprio, sem travas, e uma thread de fundo as grava em blocos grandes; a escrita no terminal sai da seção crítica e deixa de ditar a vazão.
+- **Crivo segmentado** (`CrivoSegmentado`): um cursor atômico distribui segmentos disjuntos do crivo de Eratóstenes entre os produtores, que os processam sem travas; o custo de produção deixa de esconder o da fila.
 - **Cancelamento cooperativo**:
   - Os consumidores verificam periodicamente `stop_requested()` e também são liberados de `cv.wait()` pela chamada a `cv.notify_all()` após o término dos produtores.
   - Os produtores verificam o `stop_token` dentro de seus laços principais.
@@ -38,36 +50,41 @@ Essa implementação demonstra um modelo moderno de cancelamento cooperativo em
 #include <condition_variable>
 #include <queue>
 #include <vector>
-#include <cmath>
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <string>
+
+#include "produtor_consumidor_anel.hpp"
+#include "produtor_consumidor_espera.hpp"
+#include "produtor_consumidor_primos.hpp"
+#include "produtor_consumidor_registro.hpp"
 
 std::mutex mtx;
 std::condition_variable cv;
 std::queue<int> buffer;
-
-bool is_prime(int n) {
-    if (n < 2) return false;
-    for (int i = 2; i <= std::sqrt(n); ++i)
-        if (n % i == 0) return false;
-    return true;
-}
+std::unique_ptr<Espera> espera;       // com --espera=adaptativa, substitui a variável de condição
+std::unique_ptr<AnelMPMC<int>> anel;  // com --anel, substitui o buffer acima
+std::unique_ptr<Registro> registro;
+std::unique_ptr<CrivoSegmentado> crivo;  // sem ele (--primos=divisao), cada produtor gera os primos por divisão
 
 void produtor(std::stop_token st, int id, int total) {
-    int count = 0;
-    int num = 2;
-    while (count < total && !st.stop_requested()) {
-        if (is_prime(num)) {
+    FontePrimos fonte(crivo.get());
+    for (int count = 0; count < total && !st.stop_requested(); ++count) {
+        int num = fonte.proximo();
+        if (anel) {
+            anel->push(num);
+        } else {
             {
                 std::unique_lock<std::mutex> lock(mtx);
                 buffer.push(num);
-                std::cout << "Produtor " << id << " produziu item " << num << std::endl;
             }
-            cv.notify_one();
-            count++;
+            if (espera) espera->notificar();
+            else cv.notify_one();
         }
-        num++;
+        registro->anotar(Registro::Papel::produtor, id, Registro::Evento::item, num);
     }
-    std::cout << "Produtor " << id << " concluiu." << std::endl;
+    registro->anotar(Registro::Papel::produtor, id, Registro::Evento::concluiu);
 }
 
 void consumidor(std::stop_token st, int id) {
@@ -82,15 +99,71 @@ void consumidor(std::stop_token st, int id) {
             val = buffer.front();
             buffer.pop();
         }
-        std::cout << "Consumidor " << id << " consumiu item " << val << std::endl;
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
+    }
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
+}
+
+// Consumidor da opção --anel: `pop` dorme até chegar um item ou até a parada
+// ser pedida com o anel vazio.
+void consumidor_anel(std::stop_token st, int id) {
+    int val = 0;
+    while (anel->pop(val, st))
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
+}
+
+// Consumidor da opção --espera=adaptativa: como `consumidor`, mas esvazia o
+// buffer antes de atender à parada.
+void consumidor_adaptativo(std::stop_token st, int id) {
+    while (true) {
+        int val = 0;
+        bool retirou = false;
+        espera->esperar([&] {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (buffer.empty()) return st.stop_requested();
+            val = buffer.front();
+            buffer.pop();
+            return retirou = true;
+        });
+        if (!retirou) break;
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
     }
-    std::cout << "Consumidor " << id << " concluiu." << std::endl;
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
 }
 
 int main(int argc, char* argv[]) {
     int total = std::stoi(argv[1]);
     int num_produtores = std::stoi(argv[2]);
     int num_consumidores = std::stoi(argv[3]);
+    size_t capacidade_anel = 0;
+    bool adaptativa = false;
+    int giros = Espera::giros_padrao();
+    bool latencia = false;
+    bool divisao = false;
+    bool silencioso = false;
+    unsigned amostra = 1;
+    for (int i = 4; i < argc; ++i) {
+        std::string opcao = argv[i];
+        if (opcao == "--anel") capacidade_anel = 1024;
+        else if (opcao.starts_with("--anel=")) capacidade_anel = std::max<size_t>(1, std::stoul(opcao.substr(7)));
+        else if (opcao == "--espera=adaptativa") adaptativa = true;
+        else if (opcao.starts_with("--giros=")) giros = std::max(0, std::stoi(opcao.substr(8)));
+        else if (opcao == "--latencia") latencia = true;
+        else if (opcao == "--primos=divisao") divisao = true;
+        else if (opcao == "--primos=crivo") divisao = false;
+        else if (opcao == "--silencioso") silencioso = true;
+        else if (opcao.starts_with("--amostra=")) amostra = std::stoul(opcao.substr(10));
+        else {
+            std::cerr << "Opcao desconhecida: " << opcao << std::endl;
+            return 1;
+        }
+    }
+    if (capacidade_anel > 0) anel = std::make_unique<AnelMPMC<int>>(capacidade_anel, giros, latencia);
+    else if (adaptativa) espera = std::make_unique<Espera>(giros, latencia);
+    if (!divisao) crivo = std::make_unique<CrivoSegmentado>();
+    registro = std::make_unique<Registro>(silencioso, amostra);
+    auto inicio = std::chrono::steady_clock::now();
 
     std::vector<std::jthread> produtores;
     for (int i = 0; i < num_produtores; ++i)
@@ -98,7 +171,7 @@ int main(int argc, char* argv[]) {
 
     std::vector<std::jthread> consumidores;
     for (int i = 0; i < num_consumidores; ++i)
-        consumidores.emplace_back(consumidor, i + 1);
+        consumidores.emplace_back(anel ? consumidor_anel : espera ? consumidor_adaptativo : consumidor, i + 1);
 
     for (auto& p : produtores) {
         if (p.joinable())
@@ -109,8 +182,19 @@ int main(int argc, char* argv[]) {
         c.request_stop();
     }
 
-    cv.notify_all();
+    if (espera) espera->notificar_todos();
+    else cv.notify_all();
+
+    for (auto& c : consumidores) c.join();
+
+    std::chrono::duration<double> decorrido = std::chrono::steady_clock::now() - inicio;
+    registro->encerrar();
+    long long itens = static_cast<long long>(total) * num_produtores;
+    std::cout << "Vazao: " << itens << " itens em " << decorrido.count() << " s ("
+              << itens / decorrido.count() << " itens/s)" << std::endl;
+    if (latencia && (anel || espera))
+        std::cout << "Espera: " << (anel ? anel->itens() : *espera).relatorio() << std::endl;
 
-    return 0;// jthread faz join automaticamente
+    return 0;
 }
 
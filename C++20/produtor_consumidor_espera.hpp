@@ -0,0 +1,172 @@
+/*
+Estratégia de espera adaptativa para os programas produtor/consumidor: gira um
+pouco e, se a espera se prolonga, dorme com `std::atomic::wait` (C++20).
+
+`esperar(pronto)` retorna quando `pronto()` for verdadeiro. Primeiro, testa
+`pronto` até `giros` vezes, intercalando a instrução `pause` (que alivia o
+núcleo vizinho no hyperthreading e o barramento de memória): se o item chegar
+logo, a thread o pega sem passar pelo núcleo do sistema. Em seguida, cede o
+processador algumas vezes (`yield`), o que basta quando quem vai satisfazer a
+condição está na fila de prontos do mesmo núcleo. Por fim, registra-se como
+adormecida e bloqueia em `sinal.wait`. `notificar`, chamada por quem
+acabou de tornar `pronto` verdadeiro, só incrementa o sinal e acorda alguém se
+houver threads adormecidas; com todas girando ou ocupadas, custa uma barreira
+de memória e uma leitura, sem chamada de sistema. As barreiras `seq_cst` dos
+dois lados garantem que, ou quem notifica vê a thread adormecida, ou a thread
+vê a condição já satisfeita antes de dormir, e nenhum aviso se perde.
+
+Em uma máquina com um único processador, girar só atrasa a thread que vai
+tornar `pronto` verdadeiro; por isso, `giros_padrao()` é 0 nesse caso.
+
+`std::atomic::wait` não aceita prazo; `esperar_ate` gira e depois cede o
+processador (`yield`) até o prazo.
+
+Com `medir`, cada espera que não foi satisfeita de imediato registra a sua
+latência de despertar: o tempo entre o último `notificar` e o momento em que a
+thread viu a condição satisfeita. `relatorio` resume as amostras em
+percentis.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Espera {
+public:
+    static constexpr int GIROS_PADRAO = 256;
+    static constexpr int CESSOES = 8;
+
+    static int giros_padrao() { return std::thread::hardware_concurrency() > 1 ? GIROS_PADRAO : 0; }
+
+    static void pausar() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+private:
+    alignas(64) std::atomic<std::uint32_t> sinal{0};
+    alignas(64) std::atomic<std::uint32_t> dormindo{0};
+    alignas(64) std::atomic<std::int64_t> ultimo_aviso{0};
+    int giros;
+    bool medir;
+    std::mutex mtx_amostras;
+    std::vector<std::int64_t> amostras;  // nanossegundos
+    size_t adormecidas = 0;              // esperas que chegaram a dormir
+
+    static std::int64_t agora() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void registrar(std::int64_t inicio, bool dormiu) {
+        if (!medir) return;
+        std::int64_t fim = agora();
+        std::int64_t aviso = std::max(inicio, ultimo_aviso.load(std::memory_order_relaxed));
+        std::lock_guard<std::mutex> lock(mtx_amostras);
+        amostras.push_back(std::max<std::int64_t>(0, fim - aviso));
+        adormecidas += dormiu;
+    }
+
+    // Gira até `giros` vezes e cede o processador outras `CESSOES`; devolve se
+    // `pronto` foi satisfeita.
+    template <typename Pronto>
+    bool girar(Pronto& pronto) {
+        for (int i = 0; i < giros; ++i) {
+            pausar();
+            if (pronto()) return true;
+        }
+        for (int i = 0; i < CESSOES; ++i) {
+            std::this_thread::yield();
+            if (pronto()) return true;
+        }
+        return false;
+    }
+
+public:
+    explicit Espera(int giros = giros_padrao(), bool medir = false) : giros(giros), medir(medir) {}
+    Espera(const Espera&) = delete;
+    Espera& operator=(const Espera&) = delete;
+
+    template <typename Pronto>
+    void esperar(Pronto&& pronto) {
+        if (pronto()) return;
+        std::int64_t inicio = medir ? agora() : 0;
+        if (girar(pronto)) {
+            registrar(inicio, false);
+            return;
+        }
+        while (true) {
+            std::uint32_t visto = sinal.load(std::memory_order_acquire);
+            dormindo.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool satisfeita = pronto();
+            if (!satisfeita) sinal.wait(visto, std::memory_order_acquire);
+            dormindo.fetch_sub(1, std::memory_order_relaxed);
+            if (satisfeita || pronto()) {
+                registrar(inicio, true);
+                return;
+            }
+        }
+    }
+
+    template <typename Pronto>
+    bool esperar_ate(Pronto&& pronto, std::chrono::steady_clock::time_point prazo) {
+        if (pronto()) return true;
+        std::int64_t inicio = medir ? agora() : 0;
+        bool satisfeita = girar(pronto);
+        while (!satisfeita && std::chrono::steady_clock::now() < prazo) {
+            std::this_thread::yield();
+            satisfeita = pronto();
+        }
+        if (satisfeita) registrar(inicio, false);
+        return satisfeita;
+    }
+
+    // Acorda uma thread adormecida, se houver.
+    void notificar() {
+        if (medir) ultimo_aviso.store(agora(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (dormindo.load(std::memory_order_relaxed) > 0) {
+            sinal.fetch_add(1, std::memory_order_release);
+            sinal.notify_one();
+        }
+    }
+
+    // Acorda todas as threads adormecidas (por exemplo, ao encerrar).
+    void notificar_todos() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (dormindo.load(std::memory_order_relaxed) > 0) {
+            sinal.fetch_add(1, std::memory_order_release);
+            sinal.notify_all();
+        }
+    }
+
+    // Percentis da latência de despertar, em microssegundos.
+    std::string relatorio() {
+        std::lock_guard<std::mutex> lock(mtx_amostras);
+        std::ostringstream saida;
+        saida << amostras.size() << " esperas (" << adormecidas << " dormiram)";
+        if (amostras.empty()) return saida.str();
+        std::vector<std::int64_t> ordenadas = amostras;
+        std::sort(ordenadas.begin(), ordenadas.end());
+        auto percentil = [&](double p) {
+            return ordenadas[std::min(ordenadas.size() - 1, static_cast<size_t>(p * ordenadas.size()))] / 1000.0;
+        };
+        saida << ", latencia de despertar (us): p50 " << percentil(0.50) << ", p90 " << percentil(0.90)
+              << ", p99 " << percentil(0.99) << ", max " << ordenadas.back() / 1000.0;
+        return saida.str();
+    }
+};
@@ -20,11 +20,23 @@ Exemplo de uso:
 
 Esse comando cria 2 produtores, cada um gerando 5 números primos, e 2 consumidores para processar os dados.
 
+Os produtores repartem entre si um crivo de Eratóstenes segmentado (`produtor_consumidor_primos.hpp`), de modo que cada um produz primos diferentes dos demais. Com `--primos=divisao`, cada produtor volta a testar todos os inteiros a partir de 2 por divisão, e todos produzem os mesmos primos.
+
+Opcionalmente, `--anel[=capacidade]` troca a fila protegida pelo mutex por um anel limitado sem travas (`produtor_consumidor_anel.hpp`, capacidade padrão 1024). Ao final, o programa informa a vazão em itens por segundo.
+
+`--giros=N` define quantas vezes um consumidor ocioso testa a fila antes de dormir (padrão 256, ou 0 com um único processador), e `--latencia` mede o tempo entre a chegada de um item e o despertar do consumidor, informando os percentis ao final.
+
+As mensagens de produção e consumo são escritas por uma thread de fundo (`produtor_consumidor_registro.hpp`). `--silencioso` omite as mensagens de item, mantendo as de conclusão, e `--amostra=N` escreve só uma a cada N mensagens de item de cada thread.
+
 Recursos de Programação Concorrente Utilizados
 
 - **`std::thread`**: criação de threads manuais para produtores e consumidores.
 - **`std::promise` e `std::future`**: cada produtor recebe uma `std::promise<void>`, permitindo que a thread principal aguarde sua conclusão por meio do respectivo `future`.
 - **`std::mutex`**: proteção de acesso ao buffer compartilhado (`std::queue<int> buffer`).
+- **Espera adaptativa** (`produtor_consumidor_espera.hpp`): com o buffer vazio, o consumidor gira por alguns instantes e depois dorme com `std::atomic::wait`; cada produtor avisa com `notify_one` depois de inserir, o que só chega ao sistema operacional se houver consumidor adormecido. Assim, o consumidor nem sonda o buffer em intervalos fixos nem atrasa os itens à espera do fim de um intervalo.
+- **Fila circular MPMC sem travas** (opção `--anel`): produtores e consumidores usam as operações bloqueantes do anel, que esperam por espaço ou por itens sem o mutex global; o anel cheio segura os produtores e limita a memória.
+- **Registro assíncrono**: produtores e consumidores não escrevem em `std::cout`; cada um anota as suas mensagens em um anel próprio, sem travas, e uma thread de fundo as formata e grava em blocos. A thread principal encerra o registro, esvaziando os anéis, antes de informar a vazão.
+- **Crivo segmentado compartilhado**: cada produtor reserva o próximo segmento do crivo com um `fetch_add` atômico e o processa sozinho; os segmentos são disjuntos e pequenos o bastante para a cache L1, e nenhum primo é calculado duas vezes.
 - **Sinalização de término**: após todos os produtores finalizarem (sincronizados via `future::wait()`), valores especiais (-1) são inseridos no buffer para indicar o encerramento das threads consumidoras.
 
 Essa abordagem exemplifica uma técnica clássica de sincronização entre threads usando promessas e futuros, sem o uso de variáveis de condição ou cancelamento cooperativo. O controle de término dos consumidores é feito de forma explícita com um marcador de finalização no buffer.
@@ -35,61 +47,100 @@ Essa abordagem exemplifica uma técnica clássica de sincronização entre threa
 #include <future>
 #include <mutex>
 #include <queue>
-#include <cmath>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "produtor_consumidor_anel.hpp"
+#include "produtor_consumidor_espera.hpp"
+#include "produtor_consumidor_primos.hpp"
+#include "produtor_consumidor_registro.hpp"
 
 std::mutex mtx;
 std::queue<int> buffer;
-
-bool is_prime(int n) {
-    if (n < 2) return false;
-    for (int i = 2; i <= std::sqrt(n); ++i)
-        if (n % i == 0) return false;
-    return true;
-}
+std::unique_ptr<Espera> espera;       // consumidores à espera de itens no buffer
+std::unique_ptr<AnelMPMC<int>> anel;  // com --anel, substitui o buffer acima
+std::unique_ptr<Registro> registro;
+std::unique_ptr<CrivoSegmentado> crivo;  // sem ele (--primos=divisao), cada produtor gera os primos por divisão
 
 void produtor(int id, int total, std::promise<void> prom) {
-    int count = 0;
-    int num = 2;
-    while (count < total) {
-        if (is_prime(num)) {
+    FontePrimos fonte(crivo.get());
+    for (int count = 0; count < total; ++count) {
+        int num = fonte.proximo();
+        if (anel) {
+            anel->push(num);
+        } else {
             {
                 std::lock_guard<std::mutex> lock(mtx);
                 buffer.push(num);
-                std::cout << "Produtor " << id << " produziu item " << num << std::endl;
             }
-            count++;
+            espera->notificar();
         }
-        num++;
+        registro->anotar(Registro::Papel::produtor, id, Registro::Evento::item, num);
     }
-    std::cout << "Produtor " << id << " concluiu." << std::endl;
+    registro->anotar(Registro::Papel::produtor, id, Registro::Evento::concluiu);
     prom.set_value();
 }
 
 void consumidor(int id) {
     while (true) {
-        int val = -2;
-        {
+        int val = 0;
+        espera->esperar([&] {
             std::lock_guard<std::mutex> lock(mtx);
-            if (!buffer.empty()) {
-                val = buffer.front();
-                buffer.pop();
-            }
-        }
+            if (buffer.empty()) return false;
+            val = buffer.front();
+            buffer.pop();
+            return true;
+        });
         if (val == -1) break;
-        if (val >= 0) {
-            std::cout << "Consumidor " << id << " consumiu item " << val << std::endl;
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
+    }
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
+}
+
+// Consumidor da opção --anel: `pop` espera pelo próximo item, sem sondagem.
+void consumidor_anel(int id) {
+    while (true) {
+        int val = 0;
+        anel->pop(val);
+        if (val == -1) break;
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
     }
-    std::cout << "Consumidor " << id << " concluiu." << std::endl;
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
 }
 
 int main(int argc, char* argv[]) {
     int total = std::stoi(argv[1]);
     int num_produtores = std::stoi(argv[2]);
     int num_consumidores = std::stoi(argv[3]);
+    size_t capacidade_anel = 0;
+    int giros = Espera::giros_padrao();
+    bool latencia = false;
+    bool divisao = false;
+    bool silencioso = false;
+    unsigned amostra = 1;
+    for (int i = 4; i < argc; ++i) {
+        std::string opcao = argv[i];
+        if (opcao == "--anel") capacidade_anel = 1024;
+        else if (opcao.starts_with("--anel=")) capacidade_anel = std::max<size_t>(1, std::stoul(opcao.substr(7)));
+        else if (opcao.starts_with("--giros=")) giros = std::max(0, std::stoi(opcao.substr(8)));
+        else if (opcao == "--latencia") latencia = true;
+        else if (opcao == "--primos=divisao") divisao = true;
+        else if (opcao == "--primos=crivo") divisao = false;
+        else if (opcao == "--silencioso") silencioso = true;
+        else if (opcao.starts_with("--amostra=")) amostra = std::stoul(opcao.substr(10));
+        else {
+            std::cerr << "Opcao desconhecida: " << opcao << std::endl;
+            return 1;
+        }
+    }
+    if (capacidade_anel > 0) anel = std::make_unique<AnelMPMC<int>>(capacidade_anel, giros, latencia);
+    else espera = std::make_unique<Espera>(giros, latencia);
+    if (!divisao) crivo = std::make_unique<CrivoSegmentado>();
+    registro = std::make_unique<Registro>(silencioso, amostra);
+    auto inicio = std::chrono::steady_clock::now();
 
     std::vector<std::thread> produtores;
     std::vector<std::promise<void>> promessas(num_produtores);
@@ -103,19 +154,33 @@ int main(int argc, char* argv[]) {
 
     std::vector<std::thread> consumidores;
     for (int i = 0; i < num_consumidores; ++i)
-        consumidores.emplace_back(consumidor, i + 1);
+        consumidores.emplace_back(anel ? consumidor_anel : consumidor, i + 1);
 
     for (auto& f : futuros) f.wait();
 
-    {
-        std::lock_guard<std::mutex> lock(mtx);
+    if (anel) {
         for (int i = 0; i < num_consumidores; ++i)
-            buffer.push(-1);
+            anel->push(-1);
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int i = 0; i < num_consumidores; ++i)
+                buffer.push(-1);
+        }
+        espera->notificar_todos();
     }
 
     for (auto& p : produtores) p.join();
     for (auto& c : consumidores) c.join();
 
+    std::chrono::duration<double> decorrido = std::chrono::steady_clock::now() - inicio;
+    registro->encerrar();
+    long long itens = static_cast<long long>(total) * num_produtores;
+    std::cout << "Vazao: " << itens << " itens em " << decorrido.count() << " s ("
+              << itens / decorrido.count() << " itens/s)" << std::endl;
+    if (latencia)
+        std::cout << "Espera: " << (anel ? anel->itens() : *espera).relatorio() << std::endl;
+
     return 0;
 }
 
@@ -0,0 +1,107 @@
+/*
+Fontes de números primos para os produtores.
+
+Originalmente, cada produtor começa em 2 e testa todos os inteiros por
+divisão, de modo que N produtores calculam N vezes os mesmos primos e o custo
+de produção esconde o da fila. `CrivoSegmentado` é um crivo de Eratóstenes
+compartilhado: os inteiros são divididos em segmentos de `SEGMENTO` números, e
+cada produtor reserva o próximo segmento com um `fetch_add` em um cursor
+atômico e o crivo sozinho, com os primos-base (os primos ímpares até a raiz
+de `INT_MAX`, calculados uma vez no construtor). O crivo de um segmento guarda
+só os ímpares, um byte por número, e ocupa 32 KiB: cabe na cache L1 enquanto
+é marcado e percorrido. Como os segmentos são disjuntos, cada produtor emite
+primos distintos dos demais, sem nenhuma outra sincronização.
+
+`FontePrimos` é a fonte de um produtor: com um crivo, entrega os primos dos
+segmentos que reservar, em ordem; sem crivo, mantém o comportamento original
+(todos os primos a partir de 2, por divisão).
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+inline bool primo_por_divisao(int n) {
+    if (n < 2) return false;
+    for (int i = 2; i <= n / i; ++i)
+        if (n % i == 0) return false;
+    return true;
+}
+
+class CrivoSegmentado {
+public:
+    static constexpr std::int64_t SEGMENTO = 1 << 16;  // números por segmento (32 KiB de ímpares)
+
+private:
+    std::vector<int> base;  // primos ímpares até a raiz de INT_MAX
+    std::atomic<std::int64_t> cursor{0};
+
+public:
+    CrivoSegmentado() {
+        constexpr int RAIZ = 46341;  // menor inteiro cujo quadrado excede INT_MAX
+        std::vector<char> composto(RAIZ + 1, 0);
+        for (int p = 3; p <= RAIZ; p += 2) {
+            if (composto[p]) continue;
+            base.push_back(p);
+            for (int q = p * p; q <= RAIZ; q += 2 * p) composto[q] = 1;
+        }
+    }
+    CrivoSegmentado(const CrivoSegmentado&) = delete;
+    CrivoSegmentado& operator=(const CrivoSegmentado&) = delete;
+
+    // Reserva o próximo segmento e acrescenta a `primos` os seus primos, em
+    // ordem crescente; devolve `false` quando os inteiros representáveis acabam.
+    bool proximo_segmento(std::vector<int>& primos) {
+        std::int64_t inicio = cursor.fetch_add(1, std::memory_order_relaxed) * SEGMENTO;
+        std::int64_t fim = std::min<std::int64_t>(inicio + SEGMENTO, std::int64_t{INT_MAX} + 1);
+        if (inicio >= fim) return false;
+
+        // A posição i corresponde ao ímpar inicio + 2i + 1.
+        thread_local std::vector<char> composto;
+        composto.assign(SEGMENTO / 2, 0);
+        for (std::int64_t p : base) {
+            std::int64_t q = p * p;
+            if (q >= fim) break;
+            if (q < inicio) {
+                q = (inicio + p - 1) / p * p;  // primeiro múltiplo ímpar de p no segmento
+                if (q % 2 == 0) q += p;
+            }
+            for (; q < fim; q += 2 * p) composto[(q - inicio) / 2] = 1;
+        }
+        if (inicio == 0) {
+            primos.push_back(2);
+            composto[0] = 1;  // 1 não é primo
+        }
+        for (std::int64_t i = 0; inicio + 2 * i + 1 < fim; ++i)
+            if (!composto[i]) primos.push_back(static_cast<int>(inicio + 2 * i + 1));
+        return true;
+    }
+};
+
+class FontePrimos {
+    CrivoSegmentado* crivo;
+    std::vector<int> primos;  // primos do último segmento reservado
+    size_t seguinte = 0;
+    int num = 1;              // último número testado, sem crivo
+
+public:
+    explicit FontePrimos(CrivoSegmentado* crivo = nullptr) : crivo(crivo) {}
+
+    int proximo() {
+        if (!crivo) {
+            while (!primo_por_divisao(++num)) {}
+            return num;
+        }
+        while (seguinte == primos.size()) {
+            primos.clear();
+            seguinte = 0;
+            if (!crivo->proximo_segmento(primos)) throw std::overflow_error("Os primos representaveis em int acabaram.");
+        }
+        return primos[seguinte++];
+    }
+};
@@ -0,0 +1,159 @@
+/*
+Registro assíncrono das mensagens dos programas produtor/consumidor.
+
+Escrever cada mensagem em `std::cout` com `std::endl`, muitas vezes com o mutex
+do buffer travado, faz a vazão medida ser a de um terminal sincronizado por uma
+trava global. Aqui, cada thread anota registros de tamanho fixo (papel, número
+da thread, evento e valor) em um anel próprio, com uma única thread que escreve
+e uma única que lê (SPSC) e, portanto, sem travas: a anotação custa uma cópia
+de 16 bytes e uma escrita atômica. Uma thread de fundo percorre os anéis,
+formata as mensagens e as grava em blocos grandes, com um `fwrite` por bloco.
+
+O anel de cada thread é criado na sua primeira anotação e inserido com
+`compare_exchange` em uma lista encadeada; os anéis só são liberados no
+destrutor, de modo que a thread de fundo percorre a lista sem outra
+sincronização, mesmo depois que a dona do anel terminou. As mensagens de uma
+mesma thread saem na ordem em que foram anotadas; as de threads diferentes,
+não necessariamente. Com o anel cheio, a thread cede o processador até a de
+fundo liberar espaço: nenhuma mensagem se perde.
+
+Com `silencioso`, as mensagens de item são descartadas na origem e só as de
+conclusão são escritas; com `amostra` igual a N, só uma a cada N mensagens de
+item de cada thread é anotada.
+
+`encerrar` esvazia os anéis e para a thread de fundo; deve ser chamado antes
+de escrever diretamente na saída padrão, para que as mensagens saiam antes.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+class Registro {
+public:
+    enum class Papel : std::uint8_t { produtor, consumidor };
+    enum class Evento : std::uint8_t { item, concluiu };
+
+private:
+    struct Anotacao {
+        Papel papel;
+        Evento evento;
+        std::int32_t id;
+        std::int64_t valor;
+    };
+
+    struct Anel {
+        static constexpr size_t CAPACIDADE = 4096;
+        alignas(64) std::atomic<size_t> cauda{0};   // escrita pela thread dona
+        alignas(64) std::atomic<size_t> cabeca{0};  // escrita pela thread de fundo
+        size_t itens = 0;                           // mensagens de item vistas pela dona
+        Anel* proximo = nullptr;
+        Anotacao anotacoes[CAPACIDADE];
+    };
+
+    static constexpr size_t BLOCO = 1 << 16;  // bytes acumulados antes de gravar
+
+    std::atomic<Anel*> aneis{nullptr};
+    bool silencioso;
+    unsigned amostra;
+    std::atomic<bool> ativo{true};
+    std::thread escritor;
+
+    Anel& anel_local() {
+        thread_local Registro* dono = nullptr;
+        thread_local Anel* anel = nullptr;
+        if (dono != this) {
+            dono = this;
+            anel = new Anel;
+            anel->proximo = aneis.load(std::memory_order_relaxed);
+            while (!aneis.compare_exchange_weak(anel->proximo, anel, std::memory_order_release,
+                                                std::memory_order_relaxed)) {}
+        }
+        return *anel;
+    }
+
+    static void formatar(std::string& texto, const Anotacao& a) {
+        char linha[64];
+        char* p = linha;
+        auto copiar = [&](const char* s) { while (*s) *p++ = *s++; };
+        copiar(a.papel == Papel::produtor ? "Produtor " : "Consumidor ");
+        p = std::to_chars(p, linha + sizeof linha, a.id).ptr;
+        if (a.evento == Evento::concluiu) {
+            copiar(" concluiu.\n");
+        } else {
+            copiar(a.papel == Papel::produtor ? " produziu item " : " consumiu item ");
+            p = std::to_chars(p, linha + sizeof linha, a.valor).ptr;
+            *p++ = '\n';
+        }
+        texto.append(linha, p);
+    }
+
+    // Formata o que há nos anéis; devolve quantas anotações recolheu.
+    size_t recolher(std::string& texto) {
+        size_t n = 0;
+        for (Anel* a = aneis.load(std::memory_order_acquire); a; a = a->proximo) {
+            size_t cabeca = a->cabeca.load(std::memory_order_relaxed);
+            size_t cauda = a->cauda.load(std::memory_order_acquire);
+            for (; cabeca != cauda; ++cabeca, ++n)
+                formatar(texto, a->anotacoes[cabeca % Anel::CAPACIDADE]);
+            a->cabeca.store(cabeca, std::memory_order_release);
+        }
+        return n;
+    }
+
+    static void gravar(std::string& texto) {
+        std::fwrite(texto.data(), 1, texto.size(), stdout);
+        std::fflush(stdout);
+        texto.clear();
+    }
+
+    void drenar() {
+        std::string texto;
+        texto.reserve(2 * BLOCO);
+        while (ativo.load(std::memory_order_acquire)) {
+            size_t n = recolher(texto);
+            if (texto.size() >= BLOCO || (n == 0 && !texto.empty())) gravar(texto);
+            if (n == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        recolher(texto);
+        gravar(texto);
+    }
+
+public:
+    explicit Registro(bool silencioso = false, unsigned amostra = 1)
+        : silencioso(silencioso), amostra(amostra > 0 ? amostra : 1), escritor([this] { drenar(); }) {}
+    Registro(const Registro&) = delete;
+    Registro& operator=(const Registro&) = delete;
+
+    ~Registro() {
+        encerrar();
+        for (Anel* a = aneis.load(std::memory_order_acquire); a; ) {
+            Anel* proximo = a->proximo;
+            delete a;
+            a = proximo;
+        }
+    }
+
+    void anotar(Papel papel, int id, Evento evento, std::int64_t valor = 0) {
+        if (evento == Evento::item && silencioso) return;
+        Anel& a = anel_local();
+        if (evento == Evento::item && a.itens++ % amostra != 0) return;
+        size_t cauda = a.cauda.load(std::memory_order_relaxed);
+        while (cauda - a.cabeca.load(std::memory_order_acquire) == Anel::CAPACIDADE)
+            std::this_thread::yield();
+        a.anotacoes[cauda % Anel::CAPACIDADE] = {papel, evento, id, valor};
+        a.cauda.store(cauda + 1, std::memory_order_release);
+    }
+
+    // Grava tudo o que foi anotado e para a thread de fundo.
+    void encerrar() {
+        ativo.store(false, std::memory_order_release);
+        if (escritor.joinable()) escritor.join();
+    }
+};
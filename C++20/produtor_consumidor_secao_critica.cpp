@@ -20,11 +20,26 @@ Exemplo de uso:
 
 Esse comando cria 2 produtores, cada um gerando 5 números primos, e 2 consumidores.
 
+Os primos são gerados por um crivo de Eratóstenes segmentado e compartilhado (`produtor_consumidor_primos.hpp`), no qual cada produtor reserva segmentos próprios e, portanto, produz primos que nenhum outro produz. `--primos=divisao` mantém a forma original: cada produtor testa por divisão os inteiros a partir de 2 e todos produzem a mesma sequência.
+
+Opcionalmente, `--anel[=capacidade]` troca a fila protegida pelo mutex por um anel limitado sem travas (`produtor_consumidor_anel.hpp`, capacidade padrão 1024). Ao final, o programa informa a vazão em itens por segundo.
+
+Com `--lote=N`, produtores e consumidores movem os itens em lotes de até N, e `--espera_lote=us` define por quantos microssegundos um lote incompleto pode aguardar por mais itens antes de seguir. Com o padrão 0, não há espera: o produtor só envia o lote quando ele se completa (ou ao terminar), e o consumidor leva o que já houver na fila. `make bench_lotes` compara a vazão para vários tamanhos de lote.
+
+`--espera=adaptativa` mantém o buffer com mutex, mas troca a variável de condição pela espera adaptativa de `produtor_consumidor_espera.hpp`, que o anel também usa (com `--lote`, a fila com mutex continua usando a variável de condição). `--giros=N` define quantas vezes um consumidor ocioso testa a fila antes de dormir (padrão 256, ou 0 com um único processador), e `--latencia` mede o tempo entre a chegada de um item e o despertar do consumidor nessas duas formas de espera, informando os percentis ao final. `make bench_espera` mede essa latência com carga leve e pesada.
+
+`--silencioso` suprime as mensagens de item (as de conclusão continuam), e `--amostra=N` escreve apenas uma a cada N mensagens de item de cada thread. `make bench_registro` compara a vazão com as mensagens ligadas, amostradas e desligadas.
+
 Recursos de Programação Concorrente Utilizados
 
 - **`std::thread`**: criação explícita de threads produtoras e consumidoras.
 - **`std::mutex`**: proteção do acesso ao buffer compartilhado (`std::queue<int>`).
 - **`std::condition_variable`**: sincronização entre produtores e consumidores via espera ativa/passiva.
+- **Fila circular MPMC sem travas** (opção `--anel`): produtores e consumidores usam operações atômicas sobre números de sequência por posição, sem o mutex global; com o anel cheio, os produtores esperam, o que limita a memória.
+- **Espera adaptativa** (opção `--espera=adaptativa`): com o buffer vazio, o consumidor gira por alguns instantes e depois dorme com `std::atomic::wait`. O produtor avisa com `notify_one` fora do mutex, o que só chega ao sistema operacional se houver consumidor adormecido; com a variável de condição, cada item pode custar uma ida e volta ao futex.
+- **Operações em lote** (opção `--lote`): `push_n` insere um lote inteiro com uma única aquisição do mutex e uma única notificação, e `pop_ate` retira até N itens por aquisição, acordando outro consumidor se ainda sobrarem itens. No anel, as operações equivalentes reservam todas as posições do lote com um único `compare_exchange`. O produtor envia o lote quando ele se completa ou, com `--espera_lote` positiva, quando o primeiro item já esperou esse tempo; o consumidor, depois do primeiro item, aguarda até esse mesmo tempo para completar o lote.
+- **Registro assíncrono** (`produtor_consumidor_registro.hpp`): nenhuma thread escreve em `std::cout` com o mutex travado. Cada uma anota registros de tamanho fixo em um anel SPSC próprio, e uma thread de fundo os formata e grava em blocos de 64 KiB; a thread principal esvazia o registro antes de informar a vazão.
+- **Crivo segmentado compartilhado**: os produtores reservam segmentos de 65536 inteiros com `fetch_add` em um cursor atômico; o crivo de um segmento guarda só os ímpares, em 32 KiB, e é marcado com os primos até a raiz de `INT_MAX`, calculados uma vez.
 - **Controle de término com valor sentinela**: após a finalização de todos os produtores, a thread principal insere um número negativo (-1) no buffer para cada consumidor. Ao receber esse valor, os consumidores encerram sua execução.
 
 O programa demonstra um modelo clássico de concorrência baseado em exclusão mútua e sincronização explícita por condição, utilizando estruturas de baixo nível da biblioteca padrão de C++.
@@ -36,33 +51,46 @@ O programa demonstra um modelo clássico de concorrência baseado em exclusão m
 #include <condition_variable>
 #include <queue>
 #include <vector>
-#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "produtor_consumidor_anel.hpp"
+#include "produtor_consumidor_espera.hpp"
+#include "produtor_consumidor_primos.hpp"
+#include "produtor_consumidor_registro.hpp"
 
 std::mutex mtx;
 std::condition_variable cv;
 std::queue<int> buffer;
-
-bool is_prime(int n) {
-    if (n < 2) return false;
-    for (int i = 2; i <= std::sqrt(n); ++i)
-        if (n % i == 0) return false;
-    return true;
-}
+std::unique_ptr<Espera> espera;       // com --espera=adaptativa, substitui a variável de condição
+std::unique_ptr<AnelMPMC<int>> anel;  // com --anel, substitui o buffer acima
+std::unique_ptr<Registro> registro;
+std::unique_ptr<CrivoSegmentado> crivo;  // sem ele (--primos=divisao), cada produtor gera os primos por divisão
+size_t lote = 1;
+std::chrono::microseconds espera_lote{0};
 
 void produtor(int id, int total) {
-    int count = 0;
-    int num = 2;
-    while (count < total) {
-        if (is_prime(num)) {
+    FontePrimos fonte(crivo.get());
+    for (int count = 0; count < total; ++count) {
+        int num = fonte.proximo();
+        if (anel) {
+            anel->push(num);
+        } else if (espera) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                buffer.push(num);
+            }
+            espera->notificar();
+        } else {
             std::unique_lock<std::mutex> lock(mtx);
             buffer.push(num);
-            std::cout << "Produtor " << id << " produziu item " << num << std::endl;
             cv.notify_one();
-            count++;
         }
-        num++;
+        registro->anotar(Registro::Papel::produtor, id, Registro::Evento::item, num);
     }
-    std::cout << "Produtor " << id << " concluiu." << std::endl;
+    registro->anotar(Registro::Papel::produtor, id, Registro::Evento::concluiu);
 }
 
 void consumidor(int id) {
@@ -76,27 +104,165 @@ void consumidor(int id) {
             cv.notify_all();
             break;
         }
-        std::cout << "Consumidor " << id << " consumiu item " << val << std::endl;
+        lock.unlock();
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
+    }
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
+}
+
+// Consumidor da opção --espera=adaptativa: cada consumidor retira o seu próprio sentinela.
+void consumidor_adaptativo(int id) {
+    while (true) {
+        int val = 0;
+        espera->esperar([&] {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (buffer.empty()) return false;
+            val = buffer.front();
+            buffer.pop();
+            return true;
+        });
+        if (val < 0) break;
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
+    }
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
+}
+
+// Insere um lote com uma única aquisição do mutex e uma única notificação.
+void push_n(const int* itens, size_t n) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (size_t i = 0; i < n; ++i)
+            buffer.push(itens[i]);
     }
-    std::cout << "Consumidor " << id << " concluiu." << std::endl;
+    cv.notify_one();
+}
+
+// Espera pelo primeiro item e retira até `max`. Com `espera` positiva, aguarda
+// até esse tempo para que o lote se complete.
+size_t pop_ate(int* destino, size_t max, std::chrono::microseconds espera) {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [] { return !buffer.empty(); });
+    if (espera.count() > 0) {
+        // Outro consumidor pode esvaziar o buffer enquanto este aguarda.
+        cv.wait_for(lock, espera, [&] { return buffer.size() >= max || (!buffer.empty() && buffer.back() < 0); });
+        cv.wait(lock, [] { return !buffer.empty(); });
+    }
+    size_t n = 0;
+    for (; n < max && !buffer.empty(); ++n) {
+        destino[n] = buffer.front();
+        buffer.pop();
+    }
+    if (!buffer.empty()) cv.notify_one();  // sobraram itens: outro consumidor pode seguir
+    return n;
+}
+
+// Produtor da opção --lote: junta os primos em um lote local e o envia cheio
+// ou, com `espera_lote` positiva, quando o primeiro item já esperou esse tempo.
+void produtor_lotes(int id, int total) {
+    std::vector<int> itens;
+    std::chrono::steady_clock::time_point primeiro;
+    auto enviar = [&] {
+        if (anel) anel->push_n(itens.data(), itens.size());
+        else push_n(itens.data(), itens.size());
+        for (int num : itens) registro->anotar(Registro::Papel::produtor, id, Registro::Evento::item, num);
+        itens.clear();
+    };
+    FontePrimos fonte(crivo.get());
+    for (int count = 0; count < total; ++count) {
+        if (itens.empty()) primeiro = std::chrono::steady_clock::now();
+        itens.push_back(fonte.proximo());
+        if (itens.size() >= lote || (espera_lote.count() > 0 && std::chrono::steady_clock::now() - primeiro >= espera_lote))
+            enviar();
+    }
+    if (!itens.empty()) enviar();
+    registro->anotar(Registro::Papel::produtor, id, Registro::Evento::concluiu);
+}
+
+// Consumidor da opção --lote. Um lote pode trazer mais de um sentinela; os que
+// sobram voltam ao buffer, para que cada consumidor encontre o seu.
+void consumidor_lotes(int id) {
+    std::vector<int> itens(lote);
+    size_t sentinelas = 0;
+    while (sentinelas == 0) {
+        size_t n = anel ? anel->pop_ate(itens.data(), lote, espera_lote) : pop_ate(itens.data(), lote, espera_lote);
+        for (size_t i = 0; i < n; ++i) {
+            if (itens[i] < 0) sentinelas++;
+            else registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, itens[i]);
+        }
+    }
+    std::vector<int> devolver(sentinelas - 1, -1);
+    if (anel) anel->push_n(devolver.data(), devolver.size());
+    else if (!devolver.empty()) push_n(devolver.data(), devolver.size());
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
+}
+
+// Consumidor da opção --anel: sem mutex; cada consumidor retira o seu próprio sentinela.
+void consumidor_anel(int id) {
+    while (true) {
+        int val = 0;
+        anel->pop(val);
+        if (val < 0) break;
+        registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::item, val);
+    }
+    registro->anotar(Registro::Papel::consumidor, id, Registro::Evento::concluiu);
 }
 
 int main(int argc, char* argv[]) {
     int total = std::stoi(argv[1]);
     int num_produtores = std::stoi(argv[2]);
     int num_consumidores = std::stoi(argv[3]);
+    size_t capacidade_anel = 0;
+    bool adaptativa = false;
+    int giros = Espera::giros_padrao();
+    bool latencia = false;
+    bool divisao = false;
+    bool silencioso = false;
+    unsigned amostra = 1;
+    for (int i = 4; i < argc; ++i) {
+        std::string opcao = argv[i];
+        if (opcao == "--anel") capacidade_anel = 1024;
+        else if (opcao.starts_with("--anel=")) capacidade_anel = std::max<size_t>(1, std::stoul(opcao.substr(7)));
+        else if (opcao == "--espera=adaptativa") adaptativa = true;
+        else if (opcao.starts_with("--giros=")) giros = std::max(0, std::stoi(opcao.substr(8)));
+        else if (opcao == "--latencia") latencia = true;
+        else if (opcao == "--primos=divisao") divisao = true;
+        else if (opcao == "--primos=crivo") divisao = false;
+        else if (opcao == "--silencioso") silencioso = true;
+        else if (opcao.starts_with("--amostra=")) amostra = std::stoul(opcao.substr(10));
+        else if (opcao.starts_with("--lote=")) lote = std::max<size_t>(1, std::stoul(opcao.substr(7)));
+        else if (opcao.starts_with("--espera_lote=")) espera_lote = std::chrono::microseconds(std::stol(opcao.substr(14)));
+        else {
+            std::cerr << "Opcao desconhecida: " << opcao << std::endl;
+            return 1;
+        }
+    }
+    if (capacidade_anel > 0) anel = std::make_unique<AnelMPMC<int>>(capacidade_anel, giros, latencia);
+    else if (adaptativa && lote == 1) espera = std::make_unique<Espera>(giros, latencia);
+    if (!divisao) crivo = std::make_unique<CrivoSegmentado>();
+    registro = std::make_unique<Registro>(silencioso, amostra);
+    auto inicio = std::chrono::steady_clock::now();
 
     std::vector<std::thread> produtores;
     for (int i = 0; i < num_produtores; ++i)
-        produtores.emplace_back(produtor, i + 1, total);
+        produtores.emplace_back(lote > 1 ? produtor_lotes : produtor, i + 1, total);
 
     std::vector<std::thread> consumidores;
     for (int i = 0; i < num_consumidores; ++i)
-        consumidores.emplace_back(consumidor, i + 1);
+        consumidores.emplace_back(lote > 1 ? consumidor_lotes : anel ? consumidor_anel : espera ? consumidor_adaptativo : consumidor, i + 1);
 
     for (auto& p : produtores) p.join();
 
-    {
+    if (anel) {
+        for (int i = 0; i < num_consumidores; ++i)
+            anel->push(-1);
+    } else if (espera) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int i = 0; i < num_consumidores; ++i)
+                buffer.push(-1);
+        }
+        espera->notificar_todos();
+    } else {
         std::unique_lock<std::mutex> lock(mtx);
         for (int i = 0; i < num_consumidores; ++i)
             buffer.push(-1);
@@ -105,6 +271,14 @@ int main(int argc, char* argv[]) {
 
     for (auto& c : consumidores) c.join();
 
+    std::chrono::duration<double> decorrido = std::chrono::steady_clock::now() - inicio;
+    registro->encerrar();
+    long long itens = static_cast<long long>(total) * num_produtores;
+    std::cout << "Vazao (" << (anel ? "anel" : espera ? "mutex, espera adaptativa" : "mutex") << ", lote " << lote << "): " << itens << " itens em " << decorrido.count() << " s ("
+              << itens / decorrido.count() << " itens/s)" << std::endl;
+    if (latencia && (anel || espera))
+        std::cout << "Espera: " << (anel ? anel->itens() : *espera).relatorio() << std::endl;
+
     return 0;
 }
 